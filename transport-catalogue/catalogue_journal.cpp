@@ -0,0 +1,272 @@
+#include "catalogue_journal.h"
+#include "mapped_file.h"
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+using namespace std::literals;
+
+namespace serialization {
+
+    namespace {
+
+        constexpr char JOURNAL_MAGIC[8] = { 'T', 'C', 'J', 'R', 'N', 'L', '\0', '\0' };
+        constexpr uint32_t JOURNAL_FORMAT_VERSION = 2;
+        constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+        struct JournalHeader {
+            char magic[8];
+            uint32_t format_version;
+            uint32_t byte_order_mark;
+        };
+
+        // Заголовок записи: длина полезной нагрузки и её CRC32
+        struct RecordHeader {
+            uint32_t size;
+            uint32_t checksum;
+        };
+
+        enum class RecordType : uint8_t {
+            ADD_STOP = 1,
+            SET_STOPS_DISTANCE = 2,
+            ADD_BUS = 3,
+        };
+
+        std::array<uint32_t, 256> MakeCrcTable() {
+            std::array<uint32_t, 256> table{};
+            for (uint32_t i = 0; i < table.size(); ++i) {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+                }
+                table[i] = crc;
+            }
+            return table;
+        }
+
+        uint32_t ComputeCrc32(std::string_view data) {
+            static const std::array<uint32_t, 256> table = MakeCrcTable();
+            uint32_t crc = 0xFFFFFFFFu;
+            for (unsigned char c : data) {
+                crc = table[(crc ^ c) & 0xFF] ^ (crc >> 8);
+            }
+            return crc ^ 0xFFFFFFFFu;
+        }
+
+        template <typename T>
+        void Put(std::string& payload, T value) {
+            payload.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        void PutString(std::string& payload, std::string_view str) {
+            Put(payload, static_cast<uint32_t>(str.size()));
+            payload.append(str);
+        }
+
+        // Последовательно читает поля полезной нагрузки записи
+        class PayloadReader {
+        public:
+            explicit PayloadReader(std::string_view payload)
+                : payload_(payload) {
+            }
+
+            template <typename T>
+            T Get() {
+                T value;
+                std::memcpy(&value, Take(sizeof(T)).data(), sizeof(T));
+                return value;
+            }
+
+            std::string_view GetString() {
+                return Take(Get<uint32_t>());
+            }
+
+        private:
+            std::string_view Take(size_t size) {
+                if (size > payload_.size()) {
+                    throw std::runtime_error("Journal record is truncated"s);
+                }
+                std::string_view result = payload_.substr(0, size);
+                payload_.remove_prefix(size);
+                return result;
+            }
+
+            std::string_view payload_;
+        };
+
+        void CheckHeader(std::string_view data, const std::string& file_name) {
+            JournalHeader header;
+            std::memcpy(&header, data.data(), sizeof(header));
+            if (std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) != 0
+                || header.byte_order_mark != BYTE_ORDER_MARK
+                || header.format_version != JOURNAL_FORMAT_VERSION) {
+                throw std::runtime_error("Not a catalogue journal: "s + file_name);
+            }
+        }
+
+        /**
+         * Перебирает целые записи журнала и передаёт их полезную нагрузку в callback.
+         * Возвращает длину корректной части файла в байтах
+         */
+        template <typename Callback>
+        size_t ForEachRecord(std::string_view data, const std::string& file_name, Callback callback) {
+            if (data.size() < sizeof(JournalHeader)) {
+                return 0;
+            }
+            CheckHeader(data, file_name);
+            size_t pos = sizeof(JournalHeader);
+            while (data.size() - pos >= sizeof(RecordHeader)) {
+                RecordHeader header;
+                std::memcpy(&header, data.data() + pos, sizeof(header));
+                if (header.size > data.size() - pos - sizeof(RecordHeader)) {
+                    break;
+                }
+                std::string_view payload = data.substr(pos + sizeof(RecordHeader), header.size);
+                if (ComputeCrc32(payload) != header.checksum) {
+                    break;
+                }
+                callback(payload);
+                pos += sizeof(RecordHeader) + header.size;
+            }
+            return pos;
+        }
+
+        void ApplyRecord(std::string_view payload, model::TransportCatalogue& catalogue) {
+            PayloadReader reader(payload);
+            switch (static_cast<RecordType>(reader.Get<uint8_t>())) {
+            case RecordType::ADD_STOP: {
+                std::string_view name = reader.GetString();
+                double lat = reader.Get<double>();
+                double lng = reader.Get<double>();
+                catalogue.AddStop(name, { lat, lng });
+                break;
+            }
+            case RecordType::SET_STOPS_DISTANCE: {
+                std::string_view from = reader.GetString();
+                std::string_view to = reader.GetString();
+                catalogue.SetStopsDistance(from, to, reader.Get<double>());
+                break;
+            }
+            case RecordType::ADD_BUS: {
+                std::string_view name = reader.GetString();
+                bool is_roundtrip = reader.Get<uint8_t>() != 0;
+                std::vector<std::string_view> stops(reader.Get<uint32_t>());
+                for (auto& stop_name : stops) {
+                    stop_name = reader.GetString();
+                }
+                catalogue.AddBus(name, stops, is_roundtrip);
+                break;
+            }
+            default:
+                throw std::runtime_error("Unknown journal record type"s);
+            }
+        }
+
+        void WriteHeader(std::ofstream& out) {
+            JournalHeader header{};
+            std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+            header.format_version = JOURNAL_FORMAT_VERSION;
+            header.byte_order_mark = BYTE_ORDER_MARK;
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.flush();
+        }
+
+    }   //namespace
+
+    CatalogueJournal::CatalogueJournal(const std::string& file_name)
+        : file_name_(file_name) {
+        size_t valid_size = 0;
+        if (std::filesystem::exists(file_name)) {
+            io::MappedFile file(file_name);
+            valid_size = ForEachRecord(file.View(), file_name, [this](std::string_view) {
+                ++record_count_;
+                });
+        }
+        if (valid_size == 0) {
+            out_.open(file_name, std::ios::binary | std::ios::trunc);
+            WriteHeader(out_);
+        } else {
+            std::filesystem::resize_file(file_name, valid_size);
+            out_.open(file_name, std::ios::binary | std::ios::app);
+        }
+        if (!out_) {
+            throw std::runtime_error("Error: can not open file: "s + file_name);
+        }
+    }
+
+    void CatalogueJournal::OnAddStop(std::string_view stop_name, const geo::Coordinates& coord) {
+        std::string payload;
+        Put(payload, static_cast<uint8_t>(RecordType::ADD_STOP));
+        PutString(payload, stop_name);
+        Put(payload, coord.lat);
+        Put(payload, coord.lng);
+        AppendRecord(payload);
+    }
+
+    void CatalogueJournal::OnSetStopsDistance(std::string_view from, std::string_view to, double distance) {
+        std::string payload;
+        Put(payload, static_cast<uint8_t>(RecordType::SET_STOPS_DISTANCE));
+        PutString(payload, from);
+        PutString(payload, to);
+        Put(payload, distance);
+        AppendRecord(payload);
+    }
+
+    void CatalogueJournal::OnAddBus(std::string_view bus_name, const std::vector<std::string_view>& stops, bool is_roundtrip) {
+        std::string payload;
+        Put(payload, static_cast<uint8_t>(RecordType::ADD_BUS));
+        PutString(payload, bus_name);
+        Put(payload, static_cast<uint8_t>(is_roundtrip ? 1 : 0));
+        Put(payload, static_cast<uint32_t>(stops.size()));
+        for (std::string_view stop_name : stops) {
+            PutString(payload, stop_name);
+        }
+        AppendRecord(payload);
+    }
+
+    size_t CatalogueJournal::GetRecordCount() const {
+        return record_count_;
+    }
+
+    void CatalogueJournal::Reset() {
+        out_.close();
+        out_.open(file_name_, std::ios::binary | std::ios::trunc);
+        WriteHeader(out_);
+        if (!out_) {
+            throw std::runtime_error("Error: can not reset journal: "s + file_name_);
+        }
+        record_count_ = 0;
+    }
+
+    void CatalogueJournal::AppendRecord(const std::string& payload) {
+        RecordHeader header{ static_cast<uint32_t>(payload.size()), ComputeCrc32(payload) };
+        out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out_.write(payload.data(), payload.size());
+        out_.flush();
+        if (!out_) {
+            throw std::runtime_error("Error: can not write journal: "s + file_name_);
+        }
+        ++record_count_;
+    }
+
+    size_t ReplayJournal(const std::string& file_name, model::TransportCatalogue& catalogue) {
+        if (!std::filesystem::exists(file_name)) {
+            return 0;
+        }
+        io::MappedFile file(file_name);
+        size_t applied = 0;
+        ForEachRecord(file.View(), file_name, [&](std::string_view payload) {
+            ApplyRecord(payload, catalogue);
+            ++applied;
+            });
+        return applied;
+    }
+
+    void CompactJournal(const model::TransportCatalogue& catalogue, const std::string& snapshot_file, CatalogueJournal& journal) {
+        ReplaceSnapshot(catalogue, snapshot_file);
+        journal.Reset();
+    }
+
+}
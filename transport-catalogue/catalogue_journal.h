@@ -0,0 +1,51 @@
+#pragma once
+
+#include "catalogue_snapshot.h"
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Журнал изменений справочника: двоичный файл, в который дописываются записи
+ * AddStop / SetStopsDistance / AddBus. Каждая запись защищена контрольной суммой CRC32.
+ * При запуске журнал проигрывается поверх последнего снимка; периодически справочник
+ * сжимается в новый снимок, а журнал очищается.
+ * Запись задаёт состояние: повторное описание остановки или автобуса заменяет прежнее,
+ * а изменения, которые ничего не меняют, в журнал не попадают. Поэтому повторное применение
+ * записей поверх снимка даёт тот же справочник, и сбой между записью снимка и очисткой журнала безопасен.
+ */
+namespace serialization {
+
+    class CatalogueJournal final : public model::ChangeListener {
+    public:
+        // Открывает журнал на дозапись. Повреждённый хвост (незавершённая запись) отрезается
+        explicit CatalogueJournal(const std::string& file_name);
+
+        void OnAddStop(std::string_view stop_name, const geo::Coordinates& coord) override;
+        void OnSetStopsDistance(std::string_view from, std::string_view to, double distance) override;
+        void OnAddBus(std::string_view bus_name, const std::vector<std::string_view>& stops, bool is_roundtrip) override;
+
+        size_t GetRecordCount() const;
+        // Очищает журнал, оставляя только заголовок
+        void Reset();
+
+    private:
+        void AppendRecord(const std::string& payload);
+
+        std::string file_name_;
+        std::ofstream out_;
+        size_t record_count_ = 0;
+    };
+
+    // Применяет к справочнику все целые записи журнала и возвращает их количество.
+    // Отсутствующий файл считается пустым журналом
+    size_t ReplayJournal(const std::string& file_name, model::TransportCatalogue& catalogue);
+
+    // Сохраняет справочник в новый снимок и очищает журнал
+    void CompactJournal(const model::TransportCatalogue& catalogue, const std::string& snapshot_file, CatalogueJournal& journal);
+
+}
@@ -0,0 +1,320 @@
+#include "catalogue_snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+using namespace std::literals;
+
+namespace serialization {
+
+    namespace {
+
+        constexpr char SNAPSHOT_MAGIC[8] = { 'T', 'C', 'S', 'N', 'A', 'P', '\0', '\0' };
+        constexpr uint32_t SNAPSHOT_FORMAT_VERSION = 2;
+        // Позволяет отличить снимок, записанный на машине с другим порядком байт
+        constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+        constexpr uint64_t SECTION_ALIGNMENT = 8;
+
+        struct SnapshotHeader {
+            char magic[8];
+            uint32_t format_version;
+            uint32_t byte_order_mark;
+            uint32_t stop_count;
+            uint32_t bus_count;
+            uint64_t string_pool_size;
+            uint64_t route_stop_count;
+            uint64_t distance_count;
+            uint64_t string_pool_offset;
+            uint64_t stop_names_offset;
+            uint64_t stop_lats_offset;
+            uint64_t stop_lngs_offset;
+            uint64_t distance_offsets_offset;
+            uint64_t distance_to_offset;
+            uint64_t distance_values_offset;
+            uint64_t bus_names_offset;
+            uint64_t route_offsets_offset;
+            uint64_t route_stops_offset;
+            uint64_t roundtrip_offset;
+        };
+
+        struct NameRecord {
+            uint32_t offset;
+            uint32_t length;
+        };
+        //--при чтении записи названий отображаются прямо на ссылки арены
+        static_assert(sizeof(NameRecord) == sizeof(model::StringArena::Ref)
+            && alignof(NameRecord) == alignof(model::StringArena::Ref));
+
+        class SectionWriter {
+        public:
+            explicit SectionWriter(std::ostream& out)
+                : out_(out) {
+            }
+
+            // Выравнивает позицию и записывает массив, возвращает смещение секции от начала файла
+            template <typename T>
+            uint64_t Write(const T* data, size_t count) {
+                static const char zeros[SECTION_ALIGNMENT] = {};
+                uint64_t padding = (SECTION_ALIGNMENT - pos_ % SECTION_ALIGNMENT) % SECTION_ALIGNMENT;
+                out_.write(zeros, padding);
+                pos_ += padding;
+                uint64_t offset = pos_;
+                out_.write(reinterpret_cast<const char*>(data), sizeof(T) * count);
+                pos_ += sizeof(T) * count;
+                return offset;
+            }
+
+            template <typename T>
+            uint64_t Write(const std::vector<T>& data) {
+                return Write(data.data(), data.size());
+            }
+
+        private:
+            std::ostream& out_;
+            uint64_t pos_ = 0;
+        };
+
+        // Смещения CSR: с нуля, не убывают и заканчиваются общим числом элементов total
+        bool AreOffsetsValid(const uint32_t* offsets, uint64_t count, uint64_t total) {
+            if (offsets[0] != 0 || offsets[count] != total) {
+                return false;
+            }
+            for (uint64_t i = 0; i < count; ++i) {
+                if (offsets[i] > offsets[i + 1]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool AreIdsBelow(const uint32_t* ids, uint64_t count, uint32_t bound) {
+            return std::all_of(ids, ids + count, [bound](uint32_t id) {
+                return id < bound;
+                });
+        }
+
+        NameRecord GetNameRecord(const model::StringArena& names, std::string_view name) {
+            auto ref = names.GetRef(name);
+            return { ref.offset, ref.length };
+        }
+
+    }   //namespace
+
+    void SaveSnapshot(const model::TransportCatalogue& catalogue, const std::string& file_name) {
+        const auto& stops = catalogue.GetStops();
+        const auto& buses = catalogue.GetBuses();
+
+        //--пулом строк служит арена названий справочника
+        const auto& names = catalogue.GetNames();
+        std::string string_pool;
+        string_pool.reserve(names.Size());
+        names.ForEachBlock([&string_pool](std::string_view block) {
+            string_pool.append(block);
+            });
+
+        std::vector<NameRecord> stop_names;
+        std::vector<double> stop_lats;
+        std::vector<double> stop_lngs;
+        std::unordered_map<std::string_view, uint32_t> stop_ids;
+        std::unordered_map<const model::Stop*, uint32_t> stop_ptr_ids;
+        stop_names.reserve(stops.size());
+        stop_lats.reserve(stops.size());
+        stop_lngs.reserve(stops.size());
+        for (const auto& stop : stops) {
+            uint32_t id = static_cast<uint32_t>(stop_names.size());
+            stop_ids.emplace(stop.name, id);
+            stop_ptr_ids.emplace(&stop, id);
+            stop_names.push_back(GetNameRecord(names, stop.name));
+            stop_lats.push_back(stop.coord.lat);
+            stop_lngs.push_back(stop.coord.lng);
+        }
+
+        //--расстояния группируются по остановке отправления (CSR)
+        std::vector<std::vector<std::pair<uint32_t, double>>> distances_by_stop(stops.size());
+        for (const auto& [stops_pair, distance] : catalogue.GetStopsDistances()) {
+            distances_by_stop[stop_ptr_ids.at(stops_pair.first)].emplace_back(stop_ptr_ids.at(stops_pair.second), distance);
+        }
+        std::vector<uint32_t> distance_offsets{ 0 };
+        std::vector<uint32_t> distance_to;
+        std::vector<double> distance_values;
+        for (auto& stop_distances : distances_by_stop) {
+            std::sort(stop_distances.begin(), stop_distances.end());
+            for (const auto& [to, distance] : stop_distances) {
+                distance_to.push_back(to);
+                distance_values.push_back(distance);
+            }
+            distance_offsets.push_back(static_cast<uint32_t>(distance_to.size()));
+        }
+
+        std::vector<NameRecord> bus_names;
+        std::vector<uint32_t> route_offsets{ 0 };
+        std::vector<uint32_t> route_stops;
+        std::vector<uint8_t> roundtrip;
+        for (const auto& bus : buses) {
+            bus_names.push_back(GetNameRecord(names, bus.name));
+            for (std::string_view stop_name : bus.stops) {
+                route_stops.push_back(stop_ids.at(stop_name));
+            }
+            route_offsets.push_back(static_cast<uint32_t>(route_stops.size()));
+            roundtrip.push_back(bus.is_roundtrip ? 1 : 0);
+        }
+
+        std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("Error: can not open file: "s + file_name);
+        }
+
+        SnapshotHeader header{};
+        std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.format_version = SNAPSHOT_FORMAT_VERSION;
+        header.byte_order_mark = BYTE_ORDER_MARK;
+        header.stop_count = static_cast<uint32_t>(stop_names.size());
+        header.bus_count = static_cast<uint32_t>(bus_names.size());
+        header.string_pool_size = string_pool.size();
+        header.route_stop_count = route_stops.size();
+        header.distance_count = distance_to.size();
+
+        //--заголовок перезаписывается в конце, когда известны смещения секций
+        SectionWriter writer(out);
+        writer.Write(&header, 1);
+        header.string_pool_offset = writer.Write(string_pool.data(), string_pool.size());
+        header.stop_names_offset = writer.Write(stop_names);
+        header.stop_lats_offset = writer.Write(stop_lats);
+        header.stop_lngs_offset = writer.Write(stop_lngs);
+        header.distance_offsets_offset = writer.Write(distance_offsets);
+        header.distance_to_offset = writer.Write(distance_to);
+        header.distance_values_offset = writer.Write(distance_values);
+        header.bus_names_offset = writer.Write(bus_names);
+        header.route_offsets_offset = writer.Write(route_offsets);
+        header.route_stops_offset = writer.Write(route_stops);
+        header.roundtrip_offset = writer.Write(roundtrip);
+
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        //--ошибка последнего сброса буфера (например, нет места на диске) видна только после close
+        out.close();
+        if (!out) {
+            throw std::runtime_error("Error: can not write snapshot: "s + file_name);
+        }
+    }
+
+    void ReplaceSnapshot(const model::TransportCatalogue& catalogue, const std::string& file_name) {
+        const std::string tmp_file = file_name + ".tmp"s;
+        try {
+            SaveSnapshot(catalogue, tmp_file);
+            //--данные должны попасть на диск до переименования, иначе после сбоя питания
+            //--на месте прежнего снимка может оказаться усечённый файл
+            io::SyncToDisk(tmp_file);
+            std::filesystem::rename(tmp_file, file_name);
+        } catch (...) {
+            std::error_code ignored;
+            std::filesystem::remove(tmp_file, ignored);
+            throw;
+        }
+        //--сама замена фиксируется записью каталога
+        const std::filesystem::path directory = std::filesystem::path(file_name).parent_path();
+        io::SyncToDisk(directory.empty() ? "."s : directory.string());
+    }
+
+    //-----------------------
+    CatalogueSnapshot::CatalogueSnapshot(const std::string& file_name)
+        : file_(file_name) {
+        if (file_.Size() < sizeof(SnapshotHeader)) {
+            throw std::runtime_error("Snapshot is too small: "s + file_name);
+        }
+        const auto& header = *reinterpret_cast<const SnapshotHeader*>(file_.Data());
+        if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+            throw std::runtime_error("Not a catalogue snapshot: "s + file_name);
+        }
+        if (header.byte_order_mark != BYTE_ORDER_MARK) {
+            throw std::runtime_error("Snapshot byte order mismatch: "s + file_name);
+        }
+        if (header.format_version != SNAPSHOT_FORMAT_VERSION) {
+            throw std::runtime_error("Unsupported snapshot format version "s + std::to_string(header.format_version));
+        }
+        format_version_ = header.format_version;
+        stop_count_ = header.stop_count;
+        bus_count_ = header.bus_count;
+        string_pool_size_ = header.string_pool_size;
+
+        string_pool_ = GetSection<char>(header.string_pool_offset, header.string_pool_size);
+        stop_names_ = GetSection<model::StringArena::Ref>(header.stop_names_offset, stop_count_);
+        stop_lats_ = GetSection<double>(header.stop_lats_offset, stop_count_);
+        stop_lngs_ = GetSection<double>(header.stop_lngs_offset, stop_count_);
+        distance_offsets_ = GetSection<uint32_t>(header.distance_offsets_offset, stop_count_ + 1ull);
+        distance_to_ = GetSection<uint32_t>(header.distance_to_offset, header.distance_count);
+        distance_values_ = GetSection<double>(header.distance_values_offset, header.distance_count);
+        bus_names_ = GetSection<model::StringArena::Ref>(header.bus_names_offset, bus_count_);
+        route_offsets_ = GetSection<uint32_t>(header.route_offsets_offset, bus_count_ + 1ull);
+        route_stops_ = GetSection<uint32_t>(header.route_stops_offset, header.route_stop_count);
+        roundtrip_ = GetSection<uint8_t>(header.roundtrip_offset, bus_count_);
+
+        //--все ссылки между секциями проверяются при открытии, дальнейшие обращения их не перепроверяют
+        if (!AreOffsetsValid(distance_offsets_, stop_count_, header.distance_count)
+            || !AreOffsetsValid(route_offsets_, bus_count_, header.route_stop_count)) {
+            throw std::runtime_error("Snapshot sections are inconsistent"s);
+        }
+        if (!AreIdsBelow(distance_to_, header.distance_count, stop_count_)
+            || !AreIdsBelow(route_stops_, header.route_stop_count, stop_count_)) {
+            throw std::runtime_error("Snapshot stop id is out of range"s);
+        }
+        const auto is_name_valid = [this](const model::StringArena::Ref& ref) {
+            return static_cast<uint64_t>(ref.offset) + ref.length <= string_pool_size_;
+        };
+        if (!std::all_of(stop_names_, stop_names_ + stop_count_, is_name_valid)
+            || !std::all_of(bus_names_, bus_names_ + bus_count_, is_name_valid)) {
+            throw std::runtime_error("Snapshot name is out of string pool"s);
+        }
+    }
+
+    template <typename T>
+    const T* CatalogueSnapshot::GetSection(uint64_t offset, uint64_t count) const {
+        if (offset % alignof(T) != 0 || offset > file_.Size() || count > (file_.Size() - offset) / sizeof(T)) {
+            throw std::runtime_error("Snapshot section is out of file bounds"s);
+        }
+        return reinterpret_cast<const T*>(file_.Data() + offset);
+    }
+
+    uint32_t CatalogueSnapshot::GetFormatVersion() const {
+        return format_version_;
+    }
+
+    size_t CatalogueSnapshot::GetStopCount() const {
+        return stop_count_;
+    }
+
+    size_t CatalogueSnapshot::GetBusCount() const {
+        return bus_count_;
+    }
+
+    model::CatalogueImage CatalogueSnapshot::GetImage() const {
+        model::CatalogueImage image;
+        image.name_pool = { string_pool_, string_pool_size_ };
+        image.stop_count = stop_count_;
+        image.stop_names = stop_names_;
+        image.stop_lats = stop_lats_;
+        image.stop_lngs = stop_lngs_;
+        image.distance_offsets = distance_offsets_;
+        image.distance_to = distance_to_;
+        image.distance_values = distance_values_;
+        image.bus_count = bus_count_;
+        image.bus_names = bus_names_;
+        image.route_offsets = route_offsets_;
+        image.route_stops = route_stops_;
+        image.roundtrip = roundtrip_;
+        return image;
+    }
+
+    //-----------------------
+    void RestoreCatalogue(std::shared_ptr<const CatalogueSnapshot> snapshot, model::TransportCatalogue& catalogue) {
+        model::CatalogueImage image = snapshot->GetImage();
+        image.name_pool_owner = std::move(snapshot);
+        catalogue.LoadImage(image);
+    }
+
+}
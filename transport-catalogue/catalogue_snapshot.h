@@ -0,0 +1,72 @@
+#pragma once
+
+#include "geo.h"
+#include "mapped_file.h"
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/*
+ * Бинарный снимок транспортного справочника.
+ * Снимок состоит из заголовка и плоских секций: пул строк, массивы координат остановок,
+ * маршруты автобусов в виде массивов id остановок (в прямом направлении) и таблица расстояний в формате CSR.
+ * Загрузка отображает файл в память и только вычисляет указатели на секции.
+ */
+namespace serialization {
+
+    struct SerializationSettings {
+        std::string file;
+        //--журнал изменений (необязательно) и число записей, после которого он сжимается в снимок
+        std::string journal;
+        size_t journal_compaction_threshold = 0;
+    };
+
+    // Записывает снимок справочника в файл
+    void SaveSnapshot(const model::TransportCatalogue& catalogue, const std::string& file_name);
+    // Записывает снимок во временный файл рядом с file_name, сбрасывает его на диск и атомарно заменяет им
+    // прежний снимок: сбой во время записи не портит действующий снимок, временный файл при ошибке удаляется
+    void ReplaceSnapshot(const model::TransportCatalogue& catalogue, const std::string& file_name);
+
+    class CatalogueSnapshot {
+    public:
+        // Отображает файл в память и проверяет заголовок, смещения секций и все ссылки на остановки и строки.
+        // При ошибке формата бросает std::runtime_error
+        explicit CatalogueSnapshot(const std::string& file_name);
+
+        uint32_t GetFormatVersion() const;
+        size_t GetStopCount() const;
+        size_t GetBusCount() const;
+        // Секции снимка в виде образа справочника (см. TransportCatalogue::LoadImage): массивы и пул названий
+        // указывают прямо в отображённый файл и действительны, пока жив снимок. name_pool_owner не заполняется
+        model::CatalogueImage GetImage() const;
+
+    private:
+        template <typename T>
+        const T* GetSection(uint64_t offset, uint64_t count) const;
+
+        io::MappedFile file_;
+        uint32_t format_version_ = 0;
+        uint32_t stop_count_ = 0;
+        uint32_t bus_count_ = 0;
+        const char* string_pool_ = nullptr;
+        uint64_t string_pool_size_ = 0;
+        const model::StringArena::Ref* stop_names_ = nullptr;
+        const double* stop_lats_ = nullptr;
+        const double* stop_lngs_ = nullptr;
+        const uint32_t* distance_offsets_ = nullptr;
+        const uint32_t* distance_to_ = nullptr;
+        const double* distance_values_ = nullptr;
+        const model::StringArena::Ref* bus_names_ = nullptr;
+        const uint32_t* route_offsets_ = nullptr;
+        const uint32_t* route_stops_ = nullptr;
+        const uint8_t* roundtrip_ = nullptr;
+    };
+
+    // Наполняет пустой справочник данными снимка по id, не копируя названия: справочник разделяет владение
+    // снимком, и его названия остаются view в отображённый пул строк
+    void RestoreCatalogue(std::shared_ptr<const CatalogueSnapshot> snapshot, model::TransportCatalogue& catalogue);
+
+}
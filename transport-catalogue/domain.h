@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -19,9 +22,16 @@
 
 namespace model {
 
+    // Номер остановки в порядке добавления в справочник
+    using StopId = size_t;
+    // Номер автобуса в порядке добавления в справочник
+    using BusId = size_t;
+
     struct Stop {
-        Stop(const std::string& stop_name, const geo::Coordinates& coord) : name(stop_name), coord(coord) {}
-        std::string name;
+        Stop(StopId id, std::string_view stop_name, const geo::Coordinates& coord) : id(id), name(stop_name), coord(coord) {}
+        StopId id = 0;
+        //--указывает в StringArena справочника
+        std::string_view name;
         geo::Coordinates coord;
     };
 
@@ -33,17 +43,93 @@ namespace model {
         double curvature = 0.0;
     };
 
+    /**
+     * Полный проход автобуса по маршруту без копирования остановок.
+     * Для кольцевого маршрута (A>B>C>A) это сами остановки [A,B,C,A],
+     * для некольцевого (A-B-C-D) — остановки туда и обратно [A,B,C,D,C,B,A]
+     */
+    class RouteView {
+    public:
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::string_view;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const std::string_view*;
+            using reference = std::string_view;
+
+            Iterator(const RouteView* view, size_t pos) : view_(view), pos_(pos) {}
+
+            std::string_view operator*() const {
+                return (*view_)[pos_];
+            }
+            Iterator& operator++() {
+                ++pos_;
+                return *this;
+            }
+            Iterator operator++(int) {
+                Iterator prev = *this;
+                ++pos_;
+                return prev;
+            }
+            bool operator==(const Iterator& other) const {
+                return pos_ == other.pos_;
+            }
+            bool operator!=(const Iterator& other) const {
+                return pos_ != other.pos_;
+            }
+
+        private:
+            const RouteView* view_;
+            size_t pos_;
+        };
+
+        RouteView(const std::pmr::vector<std::string_view>& stops, bool is_roundtrip)
+            : stops_(stops), is_roundtrip_(is_roundtrip) {
+        }
+
+        size_t size() const {
+            return is_roundtrip_ || stops_.empty() ? stops_.size() : 2 * stops_.size() - 1;
+        }
+        bool empty() const {
+            return stops_.empty();
+        }
+        std::string_view operator[](size_t pos) const {
+            return pos < stops_.size() ? stops_[pos] : stops_[2 * stops_.size() - 2 - pos];
+        }
+        Iterator begin() const {
+            return { this, 0 };
+        }
+        Iterator end() const {
+            return { this, size() };
+        }
+
+    private:
+        const std::pmr::vector<std::string_view>& stops_;
+        bool is_roundtrip_;
+    };
+
     struct Bus {
-        Bus(const std::string& bus_name, const std::vector<std::string_view>& route, 
-            const std::vector<std::string_view>& end_points, bool is_roundtrip, size_t end_point_idx)
-            : name(bus_name), route(route), end_points(end_points), is_roundtrip(is_roundtrip), end_point_idx(end_point_idx) {
-        }
-        std::string name;
-        std::vector<std::string_view> route;
-        //--конечные точки маршрута, одна для кольцевого и две для некольцевого
-        std::vector<std::string_view> end_points;
+        // Остановки размещаются в resource (арене справочника)
+        Bus(BusId id, std::string_view bus_name, const std::vector<std::string_view>& stops, bool is_roundtrip,
+            std::pmr::memory_resource* resource)
+            : id(id), name(bus_name), stops(stops.begin(), stops.end(), resource), is_roundtrip(is_roundtrip) {
+        }
+        // Маршрут без остановок: они дописываются в stops позже
+        Bus(BusId id, std::string_view bus_name, bool is_roundtrip, std::pmr::memory_resource* resource)
+            : id(id), name(bus_name), stops(resource), is_roundtrip(is_roundtrip) {
+        }
+        // Полный проход по маршруту (для некольцевого — туда и обратно)
+        RouteView Route() const {
+            return { stops, is_roundtrip };
+        }
+        BusId id = 0;
+        //--указывает в StringArena справочника
+        std::string_view name;
+        //--остановки в прямом направлении, как они заданы во входных данных;
+        //--конечные — stops.front() и, для некольцевого маршрута, stops.back()
+        std::pmr::vector<std::string_view> stops;
         bool is_roundtrip;
-        size_t end_point_idx = 0;
     };
 
     class StopHasher {
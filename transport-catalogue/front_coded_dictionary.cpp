@@ -0,0 +1,163 @@
+#include "front_coded_dictionary.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+    void PutVarint(std::string& out, size_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    size_t GetVarint(const std::string& in, size_t& pos) {
+        size_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            const auto byte = static_cast<unsigned char>(in[pos++]);
+            value |= static_cast<size_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+    }
+
+}
+
+namespace model {
+
+    size_t FrontCodedDictionary::Size() const {
+        return size_;
+    }
+
+    bool FrontCodedDictionary::Empty() const {
+        return size_ == 0;
+    }
+
+    void FrontCodedDictionary::Clear() {
+        data_.clear();
+        bucket_offsets_.clear();
+        size_ = 0;
+    }
+
+    void FrontCodedDictionary::Append(std::string_view prev, std::string_view str) {
+        if (size_ > 0 && !(prev < str)) {
+            throw std::invalid_argument("FrontCodedDictionary: strings must be sorted and unique");
+        }
+        if (size_ % BUCKET_SIZE == 0) {
+            if (data_.size() > std::numeric_limits<uint32_t>::max()) {
+                throw std::length_error("FrontCodedDictionary: dictionary is too large");
+            }
+            bucket_offsets_.push_back(static_cast<uint32_t>(data_.size()));
+            PutVarint(data_, str.size());
+            data_.append(str);
+        }
+        else {
+            const size_t prefix = std::mismatch(prev.begin(), prev.end(), str.begin(), str.end()).first - prev.begin();
+            PutVarint(data_, prefix);
+            PutVarint(data_, str.size() - prefix);
+            data_.append(str.substr(prefix));
+        }
+        ++size_;
+    }
+
+    std::string_view FrontCodedDictionary::GetBucketHead(size_t bucket) const {
+        size_t pos = bucket_offsets_[bucket];
+        const size_t length = GetVarint(data_, pos);
+        return { data_.data() + pos, length };
+    }
+
+    size_t FrontCodedDictionary::DecodeNext(size_t rank, size_t pos, std::string& str) const {
+        if (rank % BUCKET_SIZE == 0) {
+            const size_t length = GetVarint(data_, pos);
+            str.assign(data_, pos, length);
+            return pos + length;
+        }
+        const size_t prefix = GetVarint(data_, pos);
+        const size_t suffix = GetVarint(data_, pos);
+        str.resize(prefix);
+        str.append(data_, pos, suffix);
+        return pos + suffix;
+    }
+
+    std::string FrontCodedDictionary::Get(size_t rank) const {
+        if (rank >= size_) {
+            throw std::out_of_range("FrontCodedDictionary::Get: rank is out of range");
+        }
+        std::string str;
+        size_t pos = bucket_offsets_[rank / BUCKET_SIZE];
+        for (size_t i = rank - rank % BUCKET_SIZE; i <= rank; ++i) {
+            pos = DecodeNext(i, pos, str);
+        }
+        return str;
+    }
+
+    size_t FrontCodedDictionary::Search(std::string_view str, bool& found) const {
+        found = false;
+        //--последняя корзина, голова которой не больше str
+        size_t low = 0;
+        size_t high = bucket_offsets_.size();
+        while (low < high) {
+            const size_t mid = low + (high - low) / 2;
+            if (GetBucketHead(mid) <= str) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        if (low == 0) {
+            return 0;
+        }
+        const size_t bucket = low - 1;
+        const size_t first = bucket * BUCKET_SIZE;
+        const size_t last = std::min(first + BUCKET_SIZE, size_);
+        std::string current;
+        size_t pos = bucket_offsets_[bucket];
+        for (size_t rank = first; rank < last; ++rank) {
+            pos = DecodeNext(rank, pos, current);
+            if (!(current < str)) {
+                found = current == str;
+                return rank;
+            }
+        }
+        return last;
+    }
+
+    size_t FrontCodedDictionary::LowerBound(std::string_view str) const {
+        bool found = false;
+        return Search(str, found);
+    }
+
+    std::pair<size_t, size_t> FrontCodedDictionary::PrefixRange(std::string_view prefix) const {
+        const size_t first = LowerBound(prefix);
+        //--строки с префиксом меньше наименьшей строки, большей всех таких: у префикса отбрасываются
+        //--завершающие байты 0xff, а последний оставшийся увеличивается на единицу
+        std::string upper(prefix);
+        while (!upper.empty() && static_cast<unsigned char>(upper.back()) == 0xff) {
+            upper.pop_back();
+        }
+        if (upper.empty()) {
+            return { first, size_ };
+        }
+        upper.back() = static_cast<char>(static_cast<unsigned char>(upper.back()) + 1);
+        return { first, LowerBound(upper) };
+    }
+
+    std::optional<size_t> FrontCodedDictionary::Find(std::string_view str) const {
+        bool found = false;
+        const size_t rank = Search(str, found);
+        if (!found) {
+            return std::nullopt;
+        }
+        return rank;
+    }
+
+    size_t FrontCodedDictionary::GetMemoryUsage() const {
+        return data_.capacity() + bucket_offsets_.capacity() * sizeof(uint32_t);
+    }
+
+}
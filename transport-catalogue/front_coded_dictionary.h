@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace model {
+
+    /**
+     * Неизменный отсортированный словарь строк со сжатием общих префиксов (front coding).
+     * Строки разбиты на корзины по BUCKET_SIZE: первая строка корзины хранится целиком,
+     * остальные — как длина общего префикса с предыдущей строкой и оставшийся суффикс.
+     * Номер строки (rank) совпадает с её позицией в порядке возрастания.
+     */
+    class FrontCodedDictionary {
+    public:
+        static constexpr size_t BUCKET_SIZE = 16;
+
+        FrontCodedDictionary() = default;
+
+        // Строит словарь по диапазону строк, отсортированных по возрастанию и без повторов
+        template <typename InputIt>
+        void Build(InputIt first, InputIt last) {
+            Clear();
+            std::string_view prev;
+            for (; first != last; ++first) {
+                std::string_view str = *first;
+                Append(prev, str);
+                prev = str;
+            }
+        }
+
+        size_t Size() const;
+        bool Empty() const;
+        void Clear();
+
+        // Строка с номером rank (select)
+        std::string Get(size_t rank) const;
+        // Номер строки str (rank) либо std::nullopt, если её нет
+        std::optional<size_t> Find(std::string_view str) const;
+        // Номер первой строки, не меньшей str (Size(), если таких нет)
+        size_t LowerBound(std::string_view str) const;
+        // Номера [first, last) строк, начинающихся с prefix
+        std::pair<size_t, size_t> PrefixRange(std::string_view prefix) const;
+
+        // Перебирает строки по возрастанию, начиная с номера first: callback(rank, str).
+        // Перебор прекращается, когда callback возвращает false. str действительна до следующего вызова
+        template <typename Callback>
+        void ForEach(size_t first, Callback callback) const {
+            if (first >= size_) {
+                return;
+            }
+            std::string str;
+            size_t pos = bucket_offsets_[first / BUCKET_SIZE];
+            for (size_t rank = first - first % BUCKET_SIZE; rank < size_; ++rank) {
+                pos = DecodeNext(rank, pos, str);
+                if (rank >= first && !callback(rank, std::string_view{ str })) {
+                    return;
+                }
+            }
+        }
+
+        // Байты, занимаемые закодированными строками и смещениями корзин
+        size_t GetMemoryUsage() const;
+
+    private:
+        void Append(std::string_view prev, std::string_view str);
+        // Первая строка корзины хранится целиком, поэтому читается без копирования
+        std::string_view GetBucketHead(size_t bucket) const;
+        // Декодирует строку с номером rank, лежащую с позиции pos, поверх предыдущей строки str.
+        // Возвращает позицию следующей строки
+        size_t DecodeNext(size_t rank, size_t pos, std::string& str) const;
+        // Номер первой строки, не меньшей str; found — равна ли она str
+        size_t Search(std::string_view str, bool& found) const;
+
+        std::string data_;
+        std::vector<uint32_t> bucket_offsets_;
+        size_t size_ = 0;
+    };
+
+}
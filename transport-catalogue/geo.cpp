@@ -1,10 +1,52 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEO_HAS_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
 namespace geo {
 
+    namespace {
+        constexpr double EARTH_RADIUS = 6371000;
+        constexpr double DR = M_PI / 180.0;
+
+#ifdef GEO_HAS_AVX2_KERNEL
+        bool HasAvx2() {
+            static const bool has_avx2 = __builtin_cpu_supports("avx2");
+            return has_avx2;
+        }
+
+        // Считает косинусы углов для пар по четыре за итерацию, возвращает число обработанных пар
+        __attribute__((target("avx2")))
+        size_t ComputeCosAvx2(const double* sin_lat, const double* cos_lat, const double* sin_lng, const double* cos_lng,
+            const CoordinatesTable::PointPair* pairs, size_t count, double* out) {
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m256i from = _mm256_setr_epi64x(
+                    static_cast<long long>(pairs[i].first), static_cast<long long>(pairs[i + 1].first),
+                    static_cast<long long>(pairs[i + 2].first), static_cast<long long>(pairs[i + 3].first));
+                const __m256i to = _mm256_setr_epi64x(
+                    static_cast<long long>(pairs[i].second), static_cast<long long>(pairs[i + 1].second),
+                    static_cast<long long>(pairs[i + 2].second), static_cast<long long>(pairs[i + 3].second));
+
+                const __m256d cos_dlng = _mm256_add_pd(
+                    _mm256_mul_pd(_mm256_i64gather_pd(cos_lng, from, 8), _mm256_i64gather_pd(cos_lng, to, 8)),
+                    _mm256_mul_pd(_mm256_i64gather_pd(sin_lng, from, 8), _mm256_i64gather_pd(sin_lng, to, 8)));
+                const __m256d sin_part = _mm256_mul_pd(_mm256_i64gather_pd(sin_lat, from, 8), _mm256_i64gather_pd(sin_lat, to, 8));
+                const __m256d cos_part = _mm256_mul_pd(
+                    _mm256_mul_pd(_mm256_i64gather_pd(cos_lat, from, 8), _mm256_i64gather_pd(cos_lat, to, 8)), cos_dlng);
+                _mm256_storeu_pd(out + i, _mm256_add_pd(sin_part, cos_part));
+            }
+            return i;
+        }
+#endif
+    }   // namespace
+
     double ComputeDistance(Coordinates from, Coordinates to) {
         using namespace std;
         const double dr = M_PI / 180.0;
@@ -13,4 +55,86 @@ namespace geo {
             * 6371000;
     }
 
-}  // namespace geo
\ No newline at end of file
+    TrigCoordinates::TrigCoordinates(Coordinates coord)
+        : sin_lat(std::sin(coord.lat * DR))
+        , cos_lat(std::cos(coord.lat * DR))
+        , sin_lng(std::sin(coord.lng * DR))
+        , cos_lng(std::cos(coord.lng * DR)) {
+    }
+
+    CoordinatesTable::PointId CoordinatesTable::Add(Coordinates coord) {
+        lat_.push_back(coord.lat);
+        lng_.push_back(coord.lng);
+        sin_lat_.push_back(std::sin(coord.lat * DR));
+        cos_lat_.push_back(std::cos(coord.lat * DR));
+        sin_lng_.push_back(std::sin(coord.lng * DR));
+        cos_lng_.push_back(std::cos(coord.lng * DR));
+        return lat_.size() - 1;
+    }
+
+    void CoordinatesTable::Set(PointId id, Coordinates coord) {
+        lat_.at(id) = coord.lat;
+        lng_[id] = coord.lng;
+        sin_lat_[id] = std::sin(coord.lat * DR);
+        cos_lat_[id] = std::cos(coord.lat * DR);
+        sin_lng_[id] = std::sin(coord.lng * DR);
+        cos_lng_[id] = std::cos(coord.lng * DR);
+    }
+
+    size_t CoordinatesTable::Size() const {
+        return lat_.size();
+    }
+
+    void CoordinatesTable::Reserve(size_t count) {
+        for (auto* column : { &lat_, &lng_, &sin_lat_, &cos_lat_, &sin_lng_, &cos_lng_ }) {
+            column->reserve(count);
+        }
+    }
+
+    size_t CoordinatesTable::GetMemoryUsage() const {
+        return (lat_.capacity() + lng_.capacity() + sin_lat_.capacity() + cos_lat_.capacity()
+            + sin_lng_.capacity() + cos_lng_.capacity()) * sizeof(double);
+    }
+
+    Coordinates CoordinatesTable::Get(PointId id) const {
+        return { lat_[id], lng_[id] };
+    }
+
+    double CoordinatesTable::ComputeCos(PointId from, PointId to) const {
+        const double cos_dlng = cos_lng_[from] * cos_lng_[to] + sin_lng_[from] * sin_lng_[to];
+        return sin_lat_[from] * sin_lat_[to] + (cos_lat_[from] * cos_lat_[to]) * cos_dlng;
+    }
+
+    double CoordinatesTable::ComputeDistance(PointId from, PointId to) const {
+        return std::acos(std::clamp(ComputeCos(from, to), -1.0, 1.0)) * EARTH_RADIUS;
+    }
+
+    double CoordinatesTable::ComputeDistance(const TrigCoordinates& from, PointId to) const {
+        const double cos_dlng = from.cos_lng * cos_lng_[to] + from.sin_lng * sin_lng_[to];
+        const double cos_angle = from.sin_lat * sin_lat_[to] + (from.cos_lat * cos_lat_[to]) * cos_dlng;
+        return std::acos(std::clamp(cos_angle, -1.0, 1.0)) * EARTH_RADIUS;
+    }
+
+    void CoordinatesTable::ComputeDistances(const PointPair* pairs, size_t count, double* out) const {
+        size_t i = 0;
+#ifdef GEO_HAS_AVX2_KERNEL
+        if (HasAvx2()) {
+            i = ComputeCosAvx2(sin_lat_.data(), cos_lat_.data(), sin_lng_.data(), cos_lng_.data(), pairs, count, out);
+        }
+#endif
+        for (; i < count; ++i) {
+            out[i] = ComputeCos(pairs[i].first, pairs[i].second);
+        }
+        //--acos векторизовать нечем, поэтому он считается отдельным проходом
+        for (i = 0; i < count; ++i) {
+            out[i] = std::acos(std::clamp(out[i], -1.0, 1.0)) * EARTH_RADIUS;
+        }
+    }
+
+    std::vector<double> CoordinatesTable::ComputeDistances(const std::vector<PointPair>& pairs) const {
+        std::vector<double> distances(pairs.size());
+        ComputeDistances(pairs.data(), pairs.size(), distances.data());
+        return distances;
+    }
+
+}  // namespace geo
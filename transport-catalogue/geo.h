@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <utility>
+#include <vector>
+
 namespace geo {
 
     struct Coordinates {
@@ -16,4 +20,52 @@ namespace geo {
 
     double ComputeDistance(Coordinates from, Coordinates to);
 
-}  // namespace geo
\ No newline at end of file
+    // Точка с предвычисленными синусами и косинусами широты и долготы
+    struct TrigCoordinates {
+        explicit TrigCoordinates(Coordinates coord);
+        double sin_lat;
+        double cos_lat;
+        double sin_lng;
+        double cos_lng;
+    };
+
+    /**
+     * Таблица координат точек в виде структуры массивов.
+     * Для каждой точки заранее вычислены синусы и косинусы широты и долготы, поэтому
+     * расстояние между точками считается без тригонометрии, кроме одного acos:
+     * cos(угла) = sin φ1·sin φ2 + cos φ1·cos φ2·(cos λ1·cos λ2 + sin λ1·sin λ2)
+     */
+    class CoordinatesTable {
+    public:
+        using PointId = size_t;
+        using PointPair = std::pair<PointId, PointId>;
+
+        // Добавляет точку и возвращает её номер (номера идут подряд с нуля)
+        PointId Add(Coordinates coord);
+        // Заменяет координаты существующей точки
+        void Set(PointId id, Coordinates coord);
+        size_t Size() const;
+        void Reserve(size_t count);
+        // Байты, занимаемые массивами таблицы
+        size_t GetMemoryUsage() const;
+
+        Coordinates Get(PointId id) const;
+        double ComputeDistance(PointId from, PointId to) const;
+        double ComputeDistance(const TrigCoordinates& from, PointId to) const;
+        // Пакетное вычисление расстояний: out[i] — расстояние для pairs[i].
+        // При поддержке процессором использует AVX2, иначе скалярный код
+        void ComputeDistances(const PointPair* pairs, size_t count, double* out) const;
+        std::vector<double> ComputeDistances(const std::vector<PointPair>& pairs) const;
+
+    private:
+        double ComputeCos(PointId from, PointId to) const;
+
+        std::vector<double> lat_;
+        std::vector<double> lng_;
+        std::vector<double> sin_lat_;
+        std::vector<double> cos_lat_;
+        std::vector<double> sin_lng_;
+        std::vector<double> cos_lng_;
+    };
+
+}  // namespace geo
@@ -3,6 +3,7 @@
 #include "ranges.h"
 
 #include <cstdlib>
+#include <memory_resource>
 #include <vector>
 
 namespace graph {
@@ -25,27 +26,53 @@ bool operator==(const Edge<Weight>& left, const Edge<Weight>& right) {
 template <typename Weight>
 class DirectedWeightedGraph {
 private:
-    using IncidenceList = std::vector<EdgeId>;
+    using IncidenceList = std::pmr::vector<EdgeId>;
     using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
 
 public:
     DirectedWeightedGraph() = default;
-    explicit DirectedWeightedGraph(size_t vertex_count);
+    // Рёбра и списки инцидентности размещаются в resource
+    explicit DirectedWeightedGraph(size_t vertex_count,
+                                   std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    // Граф сразу из всех рёбер (ребро получает номер по порядку в edges). Рёбра и списки инцидентности
+    // размечаются точно по размеру, поэтому в монотонной арене не остаются брошенные при росте буферы
+    DirectedWeightedGraph(size_t vertex_count, const std::vector<Edge<Weight>>& edges,
+                          std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     EdgeId AddEdge(const Edge<Weight>& edge);
 
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+    // Байты, занимаемые рёбрами и списками инцидентности
+    size_t GetMemoryUsage() const;
 
 private:
-    std::vector<Edge<Weight>> edges_;
-    std::vector<IncidenceList> incidence_lists_;
+    std::pmr::vector<Edge<Weight>> edges_;
+    std::pmr::vector<IncidenceList> incidence_lists_;
 };
 
 template <typename Weight>
-DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-    : incidence_lists_(vertex_count) {
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count, std::pmr::memory_resource* resource)
+    : edges_(resource)
+    , incidence_lists_(vertex_count, resource) {
+}
+
+template <typename Weight>
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count, const std::vector<Edge<Weight>>& edges,
+                                                     std::pmr::memory_resource* resource)
+    : edges_(edges.begin(), edges.end(), resource)
+    , incidence_lists_(vertex_count, resource) {
+    std::vector<size_t> out_degrees(vertex_count, 0);
+    for (const Edge<Weight>& edge : edges) {
+        ++out_degrees.at(edge.from);
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        incidence_lists_[vertex].reserve(out_degrees[vertex]);
+    }
+    for (EdgeId id = 0; id < edges.size(); ++id) {
+        incidence_lists_[edges[id].from].push_back(id);
+    }
 }
 
 template <typename Weight>
@@ -71,6 +98,15 @@ const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const
     return edges_.at(edge_id);
 }
 
+template <typename Weight>
+size_t DirectedWeightedGraph<Weight>::GetMemoryUsage() const {
+    size_t bytes = edges_.capacity() * sizeof(Edge<Weight>) + incidence_lists_.capacity() * sizeof(IncidenceList);
+    for (const auto& incidence_list : incidence_lists_) {
+        bytes += incidence_list.capacity() * sizeof(EdgeId);
+    }
+    return bytes;
+}
+
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
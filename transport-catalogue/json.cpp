@@ -1,225 +1,56 @@
 #include "json.h"
+#include "swar.h"
 
-#include <iterator>
+#include <cctype>
+#include <charconv>
 
 namespace json {
 
 namespace {
 using namespace std::literals;
 
-Node LoadNode(std::istream& input);
-Node LoadString(std::istream& input);
-
-std::string LoadLiteral(std::istream& input) {
-    std::string s;
-    while (std::isalpha(input.peek())) {
-        s.push_back(static_cast<char>(input.get()));
-    }
-    return s;
-}
-
-Node LoadArray(std::istream& input) {
-    std::vector<Node> result;
-
-    for (char c; input >> c && c != ']';) {
-        if (c != ',') {
-            input.putback(c);
-        }
-        result.push_back(LoadNode(input));
-    }
-    if (!input) {
-        throw ParsingError("Array parsing error"s);
-    }
-    return Node(std::move(result));
-}
-
-Node LoadDict(std::istream& input) {
-    Dict dict;
-
-    for (char c; input >> c && c != '}';) {
-        if (c == '"') {
-            std::string key = LoadString(input).AsString();
-            if (input >> c && c == ':') {
-                if (dict.find(key) != dict.end()) {
-                    throw ParsingError("Duplicate key '"s + key + "' have been found");
-                }
-                dict.emplace(std::move(key), LoadNode(input));
-            } else {
-                throw ParsingError(": is expected but '"s + c + "' has been found"s);
-            }
-        } else if (c != ',') {
-            throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
-        }
-    }
-    if (!input) {
-        throw ParsingError("Dictionary parsing error"s);
-    }
-    return Node(std::move(dict));
+bool IsSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
 }
 
-Node LoadString(std::istream& input) {
-    auto it = std::istreambuf_iterator<char>(input);
-    auto end = std::istreambuf_iterator<char>();
-    std::string s;
-    while (true) {
-        if (it == end) {
-            throw ParsingError("String parsing error");
-        }
-        const char ch = *it;
-        if (ch == '"') {
-            ++it;
-            break;
-        } else if (ch == '\\') {
-            ++it;
-            if (it == end) {
-                throw ParsingError("String parsing error");
+// Читает очередное значение reader в дерево Node
+Node LoadNode(Reader& reader) {
+    switch (reader.Peek()) {
+        case Reader::Token::ARRAY: {
+            reader.StartArray();
+            Array result;
+            while (reader.NextItem()) {
+                result.push_back(LoadNode(reader));
             }
-            const char escaped_char = *(it);
-            switch (escaped_char) {
-                case 'n':
-                    s.push_back('\n');
-                    break;
-                case 't':
-                    s.push_back('\t');
-                    break;
-                case 'r':
-                    s.push_back('\r');
-                    break;
-                case '"':
-                    s.push_back('"');
-                    break;
-                case '\\':
-                    s.push_back('\\');
-                    break;
-                default:
-                    throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
-            }
-        } else if (ch == '\n' || ch == '\r') {
-            throw ParsingError("Unexpected end of line"s);
-        } else {
-            s.push_back(ch);
-        }
-        ++it;
-    }
-
-    return Node(std::move(s));
-}
-
-Node LoadBool(std::istream& input) {
-    const auto s = LoadLiteral(input);
-    if (s == "true"sv) {
-        return Node{true};
-    } else if (s == "false"sv) {
-        return Node{false};
-    } else {
-        throw ParsingError("Failed to parse '"s + s + "' as bool"s);
-    }
-}
-
-Node LoadNull(std::istream& input) {
-    if (auto literal = LoadLiteral(input); literal == "null"sv) {
-        return Node{nullptr};
-    } else {
-        throw ParsingError("Failed to parse '"s + literal + "' as null"s);
-    }
-}
-
-Node LoadNumber(std::istream& input) {
-    std::string parsed_num;
-
-    // Считывает в parsed_num очередной символ из input
-    auto read_char = [&parsed_num, &input] {
-        parsed_num += static_cast<char>(input.get());
-        if (!input) {
-            throw ParsingError("Failed to read number from stream"s);
-        }
-    };
-
-    // Считывает одну или более цифр в parsed_num из input
-    auto read_digits = [&input, read_char] {
-        if (!std::isdigit(input.peek())) {
-            throw ParsingError("A digit is expected"s);
-        }
-        while (std::isdigit(input.peek())) {
-            read_char();
-        }
-    };
-
-    if (input.peek() == '-') {
-        read_char();
-    }
-    // Парсим целую часть числа
-    if (input.peek() == '0') {
-        read_char();
-        // После 0 в JSON не могут идти другие цифры
-    } else {
-        read_digits();
-    }
-
-    bool is_int = true;
-    // Парсим дробную часть числа
-    if (input.peek() == '.') {
-        read_char();
-        read_digits();
-        is_int = false;
-    }
-
-    // Парсим экспоненциальную часть числа
-    if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-        read_char();
-        if (ch = input.peek(); ch == '+' || ch == '-') {
-            read_char();
+            return result;
         }
-        read_digits();
-        is_int = false;
-    }
-
-    try {
-        if (is_int) {
-            // Сначала пробуем преобразовать строку в int
-            try {
-                return std::stoi(parsed_num);
-            } catch (...) {
-                // В случае неудачи, например, при переполнении
-                // код ниже попробует преобразовать строку в double
+        case Reader::Token::DICT: {
+            reader.StartDict();
+            Dict result;
+            std::string_view key;
+            while (reader.NextKey(key)) {
+                //--ключ копируется до чтения значения: view ключа действителен только до следующего чтения
+                auto [it, inserted] = result.try_emplace(std::string(key));
+                if (!inserted) {
+                    throw ParsingError("Duplicate key '"s + it->first + "' have been found");
+                }
+                it->second = LoadNode(reader);
             }
+            return result;
         }
-        return std::stod(parsed_num);
-    } catch (...) {
-        throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
-    }
-}
-
-Node LoadNode(std::istream& input) {
-    char c;
-    if (!(input >> c)) {
-        throw ParsingError("Unexpected EOF"s);
-    }
-    switch (c) {
-        case '[':
-            return LoadArray(input);
-        case '{':
-            return LoadDict(input);
-        case '"':
-            return LoadString(input);
-        case 't':
-            // Атрибут [[fallthrough]] (провалиться) ничего не делает, и является
-            // подсказкой компилятору и человеку, что здесь программист явно задумывал
-            // разрешить переход к инструкции следующей ветки case, а не случайно забыл
-            // написать break, return или throw.
-            // В данном случае, встретив t или f, переходим к попытке парсинга
-            // литералов true либо false
-            [[fallthrough]];
-        case 'f':
-            input.putback(c);
-            return LoadBool(input);
-        case 'n':
-            input.putback(c);
-            return LoadNull(input);
-        default:
-            input.putback(c);
-            return LoadNumber(input);
+        case Reader::Token::STRING:
+            return std::string(reader.ReadString());
+        case Reader::Token::BOOL:
+            return reader.ReadBool();
+        case Reader::Token::NULL_VALUE:
+            reader.ReadNull();
+            return nullptr;
+        case Reader::Token::NUMBER:
+            return std::visit([](auto value) {
+                return Node(value);
+            }, reader.ReadNumber());
     }
+    throw ParsingError("Unexpected token"s);
 }
 
 struct PrintContext {
@@ -277,6 +108,22 @@ void PrintValue<std::string>(const std::string& value, const PrintContext& ctx)
     PrintString(value, ctx.out);
 }
 
+// Числа выводятся через to_chars: без локали и выделений памяти, double — кратчайшей записью,
+// которая читается обратно в то же значение
+template <>
+void PrintValue<int>(const int& value, const PrintContext& ctx) {
+    char buffer[16];
+    const auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+    ctx.out.write(buffer, end - buffer);
+}
+
+template <>
+void PrintValue<double>(const double& value, const PrintContext& ctx) {
+    char buffer[32];
+    const auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+    ctx.out.write(buffer, end - buffer);
+}
+
 template <>
 void PrintValue<std::nullptr_t>(const std::nullptr_t&, const PrintContext& ctx) {
     ctx.out << "null"sv;
@@ -343,8 +190,320 @@ void PrintNode(const Node& node, const PrintContext& ctx) {
 
 }  // namespace
 
+/*
+ * Пробелы и обычные символы строк пропускаются по 8 байт за раз (swar.h).
+ * Строка без escape-последовательностей возвращается как view на буфер,
+ * остальные собираются целыми отрезками между спецсимволами.
+ */
+Reader::Reader(std::string_view input)
+    : pos_(input.data())
+    , end_(input.data() + input.size()) {
+}
+
+Reader::Token Reader::Peek() {
+    SkipSpaces();
+    if (pos_ == end_) {
+        throw ParsingError("Unexpected EOF"s);
+    }
+    switch (*pos_) {
+        case '[':
+            return Token::ARRAY;
+        case '{':
+            return Token::DICT;
+        case '"':
+            return Token::STRING;
+        case 't':
+            [[fallthrough]];
+        case 'f':
+            return Token::BOOL;
+        case 'n':
+            return Token::NULL_VALUE;
+        case '-':
+            return Token::NUMBER;
+        default:
+            if (IsDigit()) {
+                return Token::NUMBER;
+            }
+            throw ParsingError("Unexpected character '"s + *pos_ + "'"s);
+    }
+}
+
+void Reader::SkipSpaces() {
+    //--отступы форматированного JSON: целые слова из пробелов
+    while (end_ - pos_ >= 8 && swar::LoadWord(pos_) == swar::ONES * ' ') {
+        pos_ += 8;
+    }
+    while (pos_ != end_ && IsSpace(*pos_)) {
+        ++pos_;
+    }
+}
+
+// Следующий значащий символ; false в конце буфера
+bool Reader::NextChar(char& c) {
+    SkipSpaces();
+    if (pos_ == end_) {
+        return false;
+    }
+    c = *pos_++;
+    return true;
+}
+
+// Длина отрезка строки до первого '"', '\\' или управляющего символа
+size_t Reader::ScanPlain(const char* ptr) const {
+    return swar::FindStringSpecial(ptr, end_);
+}
+
+std::string_view Reader::ReadString() {
+    SkipSpaces();
+    ++pos_;
+    const size_t head = ScanPlain(pos_);
+    if (pos_ + head != end_ && pos_[head] == '"') {
+        std::string_view s{ pos_, head };
+        pos_ += head + 1;
+        return s;
+    }
+    std::string& s = scratch_;
+    s.clear();
+    while (true) {
+        const size_t plain = ScanPlain(pos_);
+        s.append(pos_, plain);
+        pos_ += plain;
+        if (pos_ == end_) {
+            throw ParsingError("String parsing error");
+        }
+        const char ch = *pos_++;
+        if (ch == '"') {
+            break;
+        } else if (ch == '\\') {
+            if (pos_ == end_) {
+                throw ParsingError("String parsing error");
+            }
+            const char escaped_char = *pos_++;
+            switch (escaped_char) {
+                case 'n':
+                    s.push_back('\n');
+                    break;
+                case 't':
+                    s.push_back('\t');
+                    break;
+                case 'r':
+                    s.push_back('\r');
+                    break;
+                case '"':
+                    s.push_back('"');
+                    break;
+                case '\\':
+                    s.push_back('\\');
+                    break;
+                default:
+                    throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+            }
+        } else if (ch == '\n' || ch == '\r') {
+            throw ParsingError("Unexpected end of line"s);
+        } else {
+            //--прочие управляющие символы допускаются как есть
+            s.push_back(ch);
+        }
+    }
+    return s;
+}
+
+void Reader::StartArray() {
+    SkipSpaces();
+    ++pos_;
+}
+
+bool Reader::NextItem() {
+    char c;
+    if (!NextChar(c)) {
+        throw ParsingError("Array parsing error"s);
+    }
+    if (c == ']') {
+        return false;
+    }
+    if (c != ',') {
+        --pos_;
+    }
+    return true;
+}
+
+void Reader::StartDict() {
+    SkipSpaces();
+    ++pos_;
+}
+
+bool Reader::NextKey(std::string_view& key) {
+    char c;
+    while (NextChar(c)) {
+        if (c == '}') {
+            return false;
+        }
+        if (c == '"') {
+            --pos_;
+            key = ReadString();
+            if (NextChar(c) && c == ':') {
+                return true;
+            }
+            throw ParsingError(": is expected but '"s + c + "' has been found"s);
+        } else if (c != ',') {
+            throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+        }
+    }
+    throw ParsingError("Dictionary parsing error"s);
+}
+
+std::string_view Reader::ReadLiteral() {
+    SkipSpaces();
+    const char* begin = pos_;
+    while (pos_ != end_ && std::isalpha(static_cast<unsigned char>(*pos_))) {
+        ++pos_;
+    }
+    return { begin, static_cast<size_t>(pos_ - begin) };
+}
+
+bool Reader::ReadBool() {
+    const auto s = ReadLiteral();
+    if (s == "true"sv) {
+        return true;
+    } else if (s == "false"sv) {
+        return false;
+    }
+    throw ParsingError("Failed to parse '"s + std::string(s) + "' as bool"s);
+}
+
+void Reader::ReadNull() {
+    if (auto literal = ReadLiteral(); literal != "null"sv) {
+        throw ParsingError("Failed to parse '"s + std::string(literal) + "' as null"s);
+    }
+}
+
+bool Reader::IsDigit() const {
+    return pos_ != end_ && *pos_ >= '0' && *pos_ <= '9';
+}
+
+void Reader::SkipDigits() {
+    if (!IsDigit()) {
+        throw ParsingError("A digit is expected"s);
+    }
+    while (IsDigit()) {
+        ++pos_;
+    }
+}
+
+std::variant<int, double> Reader::ReadNumber() {
+    SkipSpaces();
+    const char* begin = pos_;
+    if (pos_ != end_ && *pos_ == '-') {
+        ++pos_;
+    }
+    // Парсим целую часть числа
+    if (pos_ != end_ && *pos_ == '0') {
+        ++pos_;
+        // После 0 в JSON не могут идти другие цифры
+    } else {
+        SkipDigits();
+    }
+
+    bool is_int = true;
+    // Парсим дробную часть числа
+    if (pos_ != end_ && *pos_ == '.') {
+        ++pos_;
+        SkipDigits();
+        is_int = false;
+    }
+
+    // Парсим экспоненциальную часть числа
+    if (pos_ != end_ && (*pos_ == 'e' || *pos_ == 'E')) {
+        ++pos_;
+        if (pos_ != end_ && (*pos_ == '+' || *pos_ == '-')) {
+            ++pos_;
+        }
+        SkipDigits();
+        is_int = false;
+    }
+
+    if (is_int) {
+        int value = 0;
+        // При переполнении int число разбирается как double
+        if (auto [ptr, ec] = std::from_chars(begin, pos_, value); ec == std::errc{}) {
+            return value;
+        }
+    }
+    double value = 0.;
+    if (auto [ptr, ec] = std::from_chars(begin, pos_, value); ec != std::errc{} || ptr != pos_) {
+        throw ParsingError("Failed to convert "s + std::string(begin, pos_) + " to number"s);
+    }
+    return value;
+}
+
+void Reader::Skip() {
+    switch (Peek()) {
+        case Token::ARRAY:
+            StartArray();
+            while (NextItem()) {
+                Skip();
+            }
+            break;
+        case Token::DICT: {
+            StartDict();
+            std::string_view key;
+            while (NextKey(key)) {
+                Skip();
+            }
+            break;
+        }
+        case Token::STRING:
+            ReadString();
+            break;
+        case Token::BOOL:
+            ReadBool();
+            break;
+        case Token::NULL_VALUE:
+            ReadNull();
+            break;
+        case Token::NUMBER:
+            ReadNumber();
+            break;
+    }
+}
+
+Document Load(std::string_view input) {
+    Reader reader(input);
+    return Document{LoadNode(reader)};
+}
+
+std::string ReadStream(std::istream& input) {
+    constexpr size_t block_size = 64 * 1024;
+    std::streambuf& stream = *input.rdbuf();
+    std::string buffer;
+    //--на байт больше остатка: короткое чтение сразу означает конец потока, без лишнего роста буфера
+    const std::streampos begin = stream.pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+    if (begin != std::streampos(-1)) {
+        const std::streampos end = stream.pubseekoff(0, std::ios_base::end, std::ios_base::in);
+        stream.pubseekpos(begin, std::ios_base::in);
+        if (end != std::streampos(-1) && end >= begin) {
+            buffer.resize(static_cast<size_t>(end - begin) + 1);
+        }
+    }
+    if (buffer.empty()) {
+        buffer.resize(block_size);
+    }
+    //--поток читается прямо в строку: ostringstream::str() сделал бы ещё одну копию документа
+    size_t size = 0;
+    while (true) {
+        size += static_cast<size_t>(stream.sgetn(buffer.data() + size, static_cast<std::streamsize>(buffer.size() - size)));
+        if (size < buffer.size()) {
+            break;
+        }
+        buffer.resize(buffer.size() * 2);
+    }
+    buffer.resize(size);
+    return buffer;
+}
+
 Document Load(std::istream& input) {
-    return Document{LoadNode(input)};
+    const std::string buffer = ReadStream(input);
+    return Load(std::string_view{buffer});
 }
 
 void Print(const Document& doc, std::ostream& output) {
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -140,6 +141,64 @@ inline bool operator!=(const Document& lhs, const Document& rhs) {
     return !(lhs == rhs);
 }
 
+/**
+ * Последовательное (pull) чтение JSON из непрерывного буфера: вызывающий сам запрашивает
+ * следующий элемент и знает, какого типа значение ожидает.
+ * Строки и ключи возвращаются как string_view, действительные до следующего чтения
+ */
+class Reader {
+public:
+    enum class Token {
+        NULL_VALUE,
+        BOOL,
+        NUMBER,
+        STRING,
+        DICT,
+        ARRAY
+    };
+
+    explicit Reader(std::string_view input);
+
+    // Тип следующего значения, ничего не читает
+    Token Peek();
+
+    void ReadNull();
+    bool ReadBool();
+    // Целое, если число без дробной части и экспоненты помещается в int
+    std::variant<int, double> ReadNumber();
+    std::string_view ReadString();
+
+    // Открывает словарь; NextKey читает очередной ключ вместе с ':' и возвращает false на '}'
+    void StartDict();
+    bool NextKey(std::string_view& key);
+    // Открывает массив; NextItem возвращает false на ']'
+    void StartArray();
+    bool NextItem();
+
+    // Пропускает следующее значение целиком
+    void Skip();
+
+private:
+    void SkipSpaces();
+    bool NextChar(char& c);
+    size_t ScanPlain(const char* ptr) const;
+    std::string_view ReadLiteral();
+    bool IsDigit() const;
+    void SkipDigits();
+
+    const char* pos_;
+    const char* end_;
+    // Буфер для строк с escape-последовательностями
+    std::string scratch_;
+};
+
+// Читает поток до конца в одну строку без промежуточных копий документа.
+// Если размер остатка потока известен (файл, строковый поток), буфер выделяется один раз
+std::string ReadStream(std::istream& input);
+
+// Разбирает документ из непрерывного буфера (через Reader)
+Document Load(std::string_view input);
+// Читает поток целиком в буфер и разбирает его
 Document Load(std::istream& input);
 
 void Print(const Document& doc, std::ostream& output);
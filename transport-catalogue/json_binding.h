@@ -0,0 +1,476 @@
+#pragma once
+
+#include "json.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/*
+ * Разбор JSON сразу в структуры C++ без промежуточного дерева Node.
+ * Поля структуры описываются constexpr-таблицей ObjectBinding<T>::FIELDS;
+ * значение каждого типа читает специализация Codec<T>.
+ */
+
+namespace json {
+
+// Ошибка привязки: отсутствующее поле или значение не того типа. Сообщение содержит путь к полю
+class BindingError : public std::logic_error {
+public:
+    using logic_error::logic_error;
+};
+
+// FNV-1a
+constexpr uint32_t HashKey(std::string_view key) {
+    uint32_t hash = 2166136261u;
+    for (char c : key) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+template <typename Owner, typename Member>
+struct Field {
+    constexpr Field(std::string_view field_name, Member Owner::* field_member, bool is_required = true)
+        : name(field_name)
+        , member(field_member)
+        , required(is_required)
+        , hash(HashKey(field_name)) {
+    }
+
+    std::string_view name;
+    Member Owner::* member;
+    bool required;
+    uint32_t hash;
+};
+
+/**
+ * Таблица полей структуры T. Специализация содержит
+ * static constexpr auto FIELDS = std::make_tuple(Field<T, ...>{...}, ...);
+ */
+template <typename T>
+struct ObjectBinding;
+
+// Хранилище для строк, которые должны пережить буфер разбора (Codec<std::string_view>)
+class StringStore {
+public:
+    virtual std::string_view Store(std::string_view str) = 0;
+
+protected:
+    ~StringStore() = default;
+};
+
+// Пары ключ-значение словаря с произвольными ключами; ключи сохраняются в StringStore
+template <typename T>
+struct Entries {
+    std::vector<std::pair<std::string_view, T>> items;
+};
+
+// Маска полей, встретившихся в объекте: бит i соответствует i-му элементу FIELDS
+using FieldMask = uint64_t;
+
+/**
+ * Состояние разбора: Reader, хранилище строк и путь к текущему значению
+ * (вида base_requests[3].latitude) для сообщений об ошибках
+ */
+class Decoder {
+public:
+    explicit Decoder(Reader& reader, StringStore* store = nullptr)
+        : reader_(reader)
+        , store_(store) {
+    }
+
+    Reader& GetReader() {
+        return reader_;
+    }
+
+    std::string_view Store(std::string_view str) {
+        if (!store_) {
+            throw std::logic_error("Decoder: string store is not set");
+        }
+        return store_->Store(str);
+    }
+
+    // Проверяет тип следующего значения
+    void Expect(Reader::Token token) {
+        if (const Reader::Token found = reader_.Peek(); found != token) {
+            Fail("expected " + std::string(GetTokenName(token)) + ", found " + std::string(GetTokenName(found)));
+        }
+    }
+
+    [[noreturn]] void Fail(const std::string& message) const {
+        throw BindingError(GetPath() + ": " + message);
+    }
+
+    void PushKey(std::string_view key) {
+        path_.push_back({ key, 0 });
+    }
+    void PushIndex(size_t index) {
+        path_.push_back({ {}, index });
+    }
+    void Pop() {
+        path_.pop_back();
+    }
+
+    std::string GetPath() const {
+        std::string path;
+        for (const auto& [key, index] : path_) {
+            if (key.data()) {
+                if (!path.empty()) {
+                    path += '.';
+                }
+                path += key;
+            } else {
+                path += '[' + std::to_string(index) + ']';
+            }
+        }
+        return path.empty() ? "<root>" : path;
+    }
+
+    static std::string_view GetTokenName(Reader::Token token) {
+        switch (token) {
+            case Reader::Token::NULL_VALUE:
+                return "null";
+            case Reader::Token::BOOL:
+                return "bool";
+            case Reader::Token::NUMBER:
+                return "number";
+            case Reader::Token::STRING:
+                return "string";
+            case Reader::Token::DICT:
+                return "dict";
+            case Reader::Token::ARRAY:
+                return "array";
+        }
+        return "value";
+    }
+
+private:
+    struct PathItem {
+        // Пустой data() у key означает индекс массива
+        std::string_view key;
+        size_t index;
+    };
+
+    Reader& reader_;
+    StringStore* store_;
+    std::vector<PathItem> path_;
+};
+
+template <typename T, typename = void>
+struct Codec;
+
+template <>
+struct Codec<bool> {
+    static void Decode(Decoder& decoder, bool& value) {
+        decoder.Expect(Reader::Token::BOOL);
+        value = decoder.GetReader().ReadBool();
+    }
+};
+
+template <>
+struct Codec<double> {
+    static void Decode(Decoder& decoder, double& value) {
+        decoder.Expect(Reader::Token::NUMBER);
+        std::visit([&value](auto number) { value = number; }, decoder.GetReader().ReadNumber());
+    }
+};
+
+// Целые читаются только из int, неотрицательность беззнаковых проверяется
+template <typename T>
+struct Codec<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+    static void Decode(Decoder& decoder, T& value) {
+        decoder.Expect(Reader::Token::NUMBER);
+        const auto number = decoder.GetReader().ReadNumber();
+        if (!std::holds_alternative<int>(number)) {
+            decoder.Fail("expected integer");
+        }
+        const int int_value = std::get<int>(number);
+        if (std::is_unsigned_v<T> && int_value < 0) {
+            decoder.Fail("expected non-negative integer");
+        }
+        value = static_cast<T>(int_value);
+    }
+};
+
+template <>
+struct Codec<std::string> {
+    static void Decode(Decoder& decoder, std::string& value) {
+        decoder.Expect(Reader::Token::STRING);
+        value = decoder.GetReader().ReadString();
+    }
+};
+
+template <>
+struct Codec<std::string_view> {
+    static void Decode(Decoder& decoder, std::string_view& value) {
+        decoder.Expect(Reader::Token::STRING);
+        value = decoder.Store(decoder.GetReader().ReadString());
+    }
+};
+
+template <typename T>
+struct Codec<std::optional<T>> {
+    static void Decode(Decoder& decoder, std::optional<T>& value) {
+        Codec<T>::Decode(decoder, value.emplace());
+    }
+};
+
+template <typename T>
+struct Codec<std::vector<T>> {
+    static void Decode(Decoder& decoder, std::vector<T>& value) {
+        decoder.Expect(Reader::Token::ARRAY);
+        Reader& reader = decoder.GetReader();
+        reader.StartArray();
+        for (size_t index = 0; reader.NextItem(); ++index) {
+            decoder.PushIndex(index);
+            Codec<T>::Decode(decoder, value.emplace_back());
+            decoder.Pop();
+        }
+    }
+};
+
+// Пара читается из массива ровно из двух элементов
+template <typename T>
+struct Codec<std::pair<T, T>> {
+    static void Decode(Decoder& decoder, std::pair<T, T>& value) {
+        decoder.Expect(Reader::Token::ARRAY);
+        Reader& reader = decoder.GetReader();
+        reader.StartArray();
+        size_t count = 0;
+        for (; reader.NextItem(); ++count) {
+            decoder.PushIndex(count);
+            if (count == 0) {
+                Codec<T>::Decode(decoder, value.first);
+            } else if (count == 1) {
+                Codec<T>::Decode(decoder, value.second);
+            } else {
+                reader.Skip();
+            }
+            decoder.Pop();
+        }
+        if (count != 2) {
+            decoder.Fail("expected array of 2 elements, found " + std::to_string(count));
+        }
+    }
+};
+
+template <typename T>
+struct Codec<Entries<T>> {
+    static void Decode(Decoder& decoder, Entries<T>& value) {
+        decoder.Expect(Reader::Token::DICT);
+        Reader& reader = decoder.GetReader();
+        reader.StartDict();
+        //--словари обычно малы (road_distances): повтор ключа ищется перебором, в длинных — по множеству ключей
+        constexpr size_t linear_scan_limit = 16;
+        std::unordered_set<std::string_view> keys;
+        std::string_view key;
+        while (reader.NextKey(key)) {
+            bool is_duplicate = false;
+            if (value.items.size() < linear_scan_limit) {
+                is_duplicate = std::any_of(value.items.begin(), value.items.end(), [key](const auto& item) {
+                    return item.first == key;
+                    });
+            } else {
+                if (keys.empty()) {
+                    for (const auto& item : value.items) {
+                        keys.insert(item.first);
+                    }
+                }
+                is_duplicate = keys.count(key) > 0;
+            }
+            if (is_duplicate) {
+                decoder.Fail("duplicate key '" + std::string(key) + "'");
+            }
+            auto& item = value.items.emplace_back();
+            item.first = decoder.Store(key);
+            if (!keys.empty()) {
+                keys.insert(item.first);
+            }
+            decoder.PushKey(item.first);
+            Codec<T>::Decode(decoder, item.second);
+            decoder.Pop();
+        }
+    }
+};
+
+namespace detail {
+
+    template <typename Fields, size_t... I>
+    constexpr bool HasDistinctHashes(const Fields& fields, std::index_sequence<I...>) {
+        const uint32_t hashes[] = { std::get<I>(fields).hash... };
+        for (size_t i = 0; i < sizeof...(I); ++i) {
+            for (size_t j = i + 1; j < sizeof...(I); ++j) {
+                if (hashes[i] == hashes[j]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    template <typename T>
+    constexpr size_t FIELD_COUNT = std::tuple_size_v<std::decay_t<decltype(ObjectBinding<T>::FIELDS)>>;
+
+    // Размер таблицы полей: степень двойки не меньше удвоенного числа полей, чтобы цепочки проб были короткими
+    constexpr size_t GetFieldTableSize(size_t count) {
+        size_t size = 1;
+        while (size < 2 * count) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    /**
+     * Открытая адресация по хэшу имени поля, построенная при компиляции:
+     * ячейка хранит номер поля + 1 (0 — пустая ячейка), коллизии разрешаются линейным пробированием
+     */
+    template <typename T, size_t... I>
+    constexpr std::array<uint8_t, GetFieldTableSize(sizeof...(I))> BuildFieldTable(std::index_sequence<I...>) {
+        constexpr size_t size = GetFieldTableSize(sizeof...(I));
+        //--нулевой элемент — заглушка, чтобы массив не был пустым
+        const uint32_t hashes[] = { 0u, std::get<I>(ObjectBinding<T>::FIELDS).hash... };
+        std::array<uint8_t, size> table{};
+        for (size_t i = 0; i < sizeof...(I); ++i) {
+            size_t slot = hashes[i + 1] & (size - 1);
+            while (table[slot] != 0) {
+                slot = (slot + 1) & (size - 1);
+            }
+            table[slot] = static_cast<uint8_t>(i + 1);
+        }
+        return table;
+    }
+
+    // Читает значение I-го поля, если key совпадает с его названием
+    template <typename T, size_t I>
+    bool DecodeFieldAt(Decoder& decoder, T& object, std::string_view key, FieldMask& seen) {
+        const auto& field = std::get<I>(ObjectBinding<T>::FIELDS);
+        if (field.name != key) {
+            return false;
+        }
+        if (seen & (FieldMask{ 1 } << I)) {
+            decoder.Fail("duplicate field '" + std::string(field.name) + "'");
+        }
+        seen |= FieldMask{ 1 } << I;
+        decoder.PushKey(field.name);
+        using Member = std::decay_t<decltype(object.*field.member)>;
+        Codec<Member>::Decode(decoder, object.*field.member);
+        decoder.Pop();
+        return true;
+    }
+
+    // Читает значение поля с ключом key; false, если в таблице такого поля нет
+    template <typename T, size_t... I>
+    bool DecodeField(Decoder& decoder, T& object, std::string_view key, FieldMask& seen, std::index_sequence<I...>) {
+        using FieldDecoder = bool (*)(Decoder&, T&, std::string_view, FieldMask&);
+        static constexpr FieldDecoder DECODERS[] = { nullptr, &DecodeFieldAt<T, I>... };
+        static constexpr uint32_t HASHES[] = { 0u, std::get<I>(ObjectBinding<T>::FIELDS).hash... };
+        static constexpr auto TABLE = BuildFieldTable<T>(std::index_sequence<I...>{});
+        constexpr size_t mask = TABLE.size() - 1;
+
+        //--хэши полей различны (проверено static_assert): первое совпадение хэша — единственный кандидат,
+        //--строка сравнивается один раз
+        const uint32_t hash = HashKey(key);
+        for (size_t slot = hash & mask; TABLE[slot] != 0; slot = (slot + 1) & mask) {
+            if (HASHES[TABLE[slot]] == hash) {
+                return DECODERS[TABLE[slot]](decoder, object, key, seen);
+            }
+        }
+        return false;
+    }
+
+    template <typename T, size_t... I>
+    void CheckRequired(Decoder& decoder, FieldMask seen, std::index_sequence<I...>) {
+        const auto check = [&](const auto& field, size_t index) {
+            if (field.required && !(seen & (FieldMask{ 1 } << index))) {
+                decoder.Fail("missing field '" + std::string(field.name) + "'");
+            }
+        };
+        (check(std::get<I>(ObjectBinding<T>::FIELDS), I), ...);
+    }
+
+    template <typename T, size_t... I>
+    FieldMask GetFieldBit(std::string_view name, std::index_sequence<I...>) {
+        FieldMask bit = 0;
+        ((std::get<I>(ObjectBinding<T>::FIELDS).name == name ? bit = FieldMask{ 1 } << I : bit), ...);
+        return bit;
+    }
+
+}  // namespace detail
+
+/**
+ * Читает объект по таблице ObjectBinding<T>::FIELDS за один проход.
+ * Неизвестные ключи пропускаются; возвращает маску встретившихся полей
+ */
+template <typename T>
+FieldMask DecodeObject(Decoder& decoder, T& object) {
+    constexpr size_t count = detail::FIELD_COUNT<T>;
+    static_assert(count <= sizeof(FieldMask) * 8, "too many fields");
+    static_assert(detail::HasDistinctHashes(ObjectBinding<T>::FIELDS, std::make_index_sequence<count>{}),
+        "field names must have distinct hashes");
+
+    decoder.Expect(Reader::Token::DICT);
+    Reader& reader = decoder.GetReader();
+    reader.StartDict();
+    FieldMask seen = 0;
+    std::string_view key;
+    while (reader.NextKey(key)) {
+        if (!detail::DecodeField(decoder, object, key, seen, std::make_index_sequence<count>{})) {
+            reader.Skip();
+        }
+    }
+    detail::CheckRequired<T>(decoder, seen, std::make_index_sequence<count>{});
+    return seen;
+}
+
+// Проверяет поля, обязательные лишь в некоторых вариантах объекта (например, по значению type)
+template <typename T>
+void RequireFields(const Decoder& decoder, FieldMask seen, std::initializer_list<std::string_view> names) {
+    for (std::string_view name : names) {
+        if (!(seen & detail::GetFieldBit<T>(name, std::make_index_sequence<detail::FIELD_COUNT<T>>{}))) {
+            decoder.Fail("missing field '" + std::string(name) + "'");
+        }
+    }
+}
+
+// Поле присутствовало в объекте
+template <typename T>
+bool HasField(FieldMask seen, std::string_view name) {
+    return seen & detail::GetFieldBit<T>(name, std::make_index_sequence<detail::FIELD_COUNT<T>>{});
+}
+
+template <typename T>
+struct Codec<T, std::void_t<decltype(ObjectBinding<T>::FIELDS)>> {
+    static void Decode(Decoder& decoder, T& value) {
+        DecodeObject(decoder, value);
+    }
+};
+
+// Читает значение типа T из всего буфера
+template <typename T>
+void Decode(std::string_view input, T& value, StringStore* store = nullptr) {
+    Reader reader(input);
+    Decoder decoder(reader, store);
+    Codec<T>::Decode(decoder, value);
+}
+
+// Читает поток целиком в буфер и разбирает его в value
+template <typename T>
+void Decode(std::istream& input, T& value, StringStore* store = nullptr) {
+    const std::string buffer = ReadStream(input);
+    Decode(std::string_view{ buffer }, value, store);
+}
+
+}  // namespace json
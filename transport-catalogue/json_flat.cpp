@@ -0,0 +1,251 @@
+#include "json_flat.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace json {
+
+using namespace std::literals;
+
+// Собирает FlatNode, читая значения из Reader: дети незавершённых контейнеров копятся в общих стеках
+// и переносятся в арену одним блоком при закрытии контейнера
+class FlatBuilder {
+public:
+    FlatBuilder(std::string_view input, std::pmr::memory_resource& arena)
+        : input_(input)
+        , arena_(arena) {
+    }
+
+    FlatNode Build() {
+        Reader reader(input_);
+        return ReadValue(reader);
+    }
+
+private:
+    FlatNode ReadValue(Reader& reader) {
+        FlatNode node;
+        switch (reader.Peek()) {
+            case Reader::Token::ARRAY:
+                return ReadArray(reader);
+            case Reader::Token::DICT:
+                return ReadDict(reader);
+            case Reader::Token::STRING: {
+                const std::string_view kept = Keep(reader.ReadString());
+                node.type_ = FlatNode::Type::STRING;
+                node.size_ = static_cast<uint32_t>(kept.size());
+                node.chars_ = kept.data();
+                break;
+            }
+            case Reader::Token::BOOL:
+                node.type_ = FlatNode::Type::BOOL;
+                node.bool_ = reader.ReadBool();
+                break;
+            case Reader::Token::NULL_VALUE:
+                reader.ReadNull();
+                break;
+            case Reader::Token::NUMBER:
+                std::visit([&node](auto value) {
+                    if constexpr (std::is_same_v<decltype(value), int>) {
+                        node.type_ = FlatNode::Type::INT;
+                        node.int_ = value;
+                    } else {
+                        node.type_ = FlatNode::Type::DOUBLE;
+                        node.double_ = value;
+                    }
+                }, reader.ReadNumber());
+                break;
+        }
+        return node;
+    }
+
+    FlatNode ReadArray(Reader& reader) {
+        reader.StartArray();
+        const size_t start = items_.size();
+        while (reader.NextItem()) {
+            //--значение читается до push_back: вложенные массивы сами дописывают и срезают стек
+            const FlatNode item = ReadValue(reader);
+            items_.push_back(item);
+        }
+        const size_t count = items_.size() - start;
+        auto* items = static_cast<FlatNode*>(arena_.allocate(count * sizeof(FlatNode), alignof(FlatNode)));
+        std::uninitialized_copy(items_.begin() + start, items_.end(), items);
+        items_.resize(start);
+
+        FlatNode node;
+        node.type_ = FlatNode::Type::ARRAY;
+        node.size_ = static_cast<uint32_t>(count);
+        node.items_ = items;
+        return node;
+    }
+
+    FlatNode ReadDict(Reader& reader) {
+        reader.StartDict();
+        const size_t start = members_.size();
+        std::string_view key;
+        while (reader.NextKey(key)) {
+            //--view ключа действителен только до следующего чтения
+            const std::string_view kept = Keep(key);
+            const FlatNode value = ReadValue(reader);
+            members_.push_back({ kept, value });
+        }
+        const size_t count = members_.size() - start;
+        auto* members = static_cast<FlatMember*>(arena_.allocate(count * sizeof(FlatMember), alignof(FlatMember)));
+        std::uninitialized_copy(members_.begin() + start, members_.end(), members);
+        members_.resize(start);
+
+        const auto by_key = [](const FlatMember& lhs, const FlatMember& rhs) {
+            return lhs.key < rhs.key;
+        };
+        std::sort(members, members + count, by_key);
+        const auto same_key = [](const FlatMember& lhs, const FlatMember& rhs) {
+            return lhs.key == rhs.key;
+        };
+        if (auto it = std::adjacent_find(members, members + count, same_key); it != members + count) {
+            throw ParsingError("Duplicate key '"s + std::string(it->key) + "' have been found");
+        }
+
+        FlatNode node;
+        node.type_ = FlatNode::Type::DICT;
+        node.size_ = static_cast<uint32_t>(count);
+        node.members_ = members;
+        return node;
+    }
+
+    // Строка, лежащая во входном буфере, хранится как есть; раскрытая из escape-последовательностей копируется в арену
+    std::string_view Keep(std::string_view str) {
+        const std::less<const char*> less;
+        if (!less(str.data(), input_.data()) && !less(input_.data() + input_.size(), str.data() + str.size())) {
+            return str;
+        }
+        auto* chars = static_cast<char*>(arena_.allocate(str.size(), alignof(char)));
+        std::copy(str.begin(), str.end(), chars);
+        return { chars, str.size() };
+    }
+
+    std::string_view input_;
+    std::pmr::memory_resource& arena_;
+    std::vector<FlatNode> items_;
+    std::vector<FlatMember> members_;
+};
+
+bool FlatNode::AsBool() const {
+    if (!IsBool()) {
+        throw std::logic_error("Not a bool"s);
+    }
+    return bool_;
+}
+
+int FlatNode::AsInt() const {
+    if (!IsInt()) {
+        throw std::logic_error("Not an int"s);
+    }
+    return int_;
+}
+
+double FlatNode::AsDouble() const {
+    if (!IsDouble()) {
+        throw std::logic_error("Not a double"s);
+    }
+    return IsPureDouble() ? double_ : int_;
+}
+
+std::string_view FlatNode::AsString() const {
+    if (!IsString()) {
+        throw std::logic_error("Not a string"s);
+    }
+    return { chars_, size_ };
+}
+
+ranges::Range<const FlatNode*> FlatNode::AsArray() const {
+    if (!IsArray()) {
+        throw std::logic_error("Not an array"s);
+    }
+    return { items_, items_ + size_ };
+}
+
+ranges::Range<const FlatMember*> FlatNode::AsDict() const {
+    if (!IsDict()) {
+        throw std::logic_error("Not a dict"s);
+    }
+    return { members_, members_ + size_ };
+}
+
+size_t FlatNode::Size() const {
+    if (!IsArray() && !IsDict()) {
+        throw std::logic_error("Not a container"s);
+    }
+    return size_;
+}
+
+const FlatNode& FlatNode::operator[](size_t index) const {
+    if (!IsArray()) {
+        throw std::logic_error("Not an array"s);
+    }
+    if (index >= size_) {
+        throw std::out_of_range("Array index out of range"s);
+    }
+    return items_[index];
+}
+
+const FlatNode* FlatNode::Find(std::string_view key) const {
+    const auto dict = AsDict();
+    const FlatMember* it = std::lower_bound(dict.begin(), dict.end(), key,
+        [](const FlatMember& member, std::string_view value) {
+            return member.key < value;
+        });
+    if (it == dict.end() || it->key != key) {
+        return nullptr;
+    }
+    return &it->value;
+}
+
+const FlatNode& FlatNode::At(std::string_view key) const {
+    if (const FlatNode* node = Find(key)) {
+        return *node;
+    }
+    throw std::out_of_range("Key '"s + std::string(key) + "' not found"s);
+}
+
+Node FlatNode::ToNode() const {
+    switch (type_) {
+        case Type::NULL_VALUE:
+            return Node{ nullptr };
+        case Type::BOOL:
+            return Node{ bool_ };
+        case Type::INT:
+            return Node{ int_ };
+        case Type::DOUBLE:
+            return Node{ double_ };
+        case Type::STRING:
+            return Node{ std::string(AsString()) };
+        case Type::ARRAY: {
+            Array array;
+            array.reserve(size_);
+            for (const FlatNode& item : AsArray()) {
+                array.push_back(item.ToNode());
+            }
+            return Node{ std::move(array) };
+        }
+        case Type::DICT: {
+            Dict dict;
+            for (const auto& [key, value] : AsDict()) {
+                dict.emplace_hint(dict.end(), std::string(key), value.ToNode());
+            }
+            return Node{ std::move(dict) };
+        }
+    }
+    return Node{};
+}
+
+FlatDocument::FlatDocument(std::string_view input)
+    //--узлы обычно занимают меньше места, чем их текст: начальный блок в четверть входа
+    : arena_(std::make_unique<std::pmr::monotonic_buffer_resource>(std::max<size_t>(input.size() / 4, 1024))) {
+    root_ = FlatBuilder(input, *arena_).Build();
+}
+
+}  // namespace json
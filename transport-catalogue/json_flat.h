@@ -0,0 +1,124 @@
+#pragma once
+
+#include "json.h"
+#include "ranges.h"
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+
+/*
+ * Плоское представление JSON-документа. Все узлы, массивы, словари и строки, которым
+ * потребовалось раскрытие escape-последовательностей, лежат в монотонной арене документа;
+ * остальные строки и ключи — view на входной буфер. Построение и удаление большого
+ * документа сводятся к нескольким крупным выделениям памяти.
+ */
+
+namespace json {
+
+struct FlatMember;
+class FlatBuilder;
+
+/**
+ * Узел плоского документа (16 байт). Элементы массива и пары словаря лежат непрерывным блоком,
+ * пары словаря отсортированы по ключу. Узел действителен, пока жив его FlatDocument
+ */
+class FlatNode {
+public:
+    enum class Type : uint8_t {
+        NULL_VALUE,
+        BOOL,
+        INT,
+        DOUBLE,
+        STRING,
+        ARRAY,
+        DICT
+    };
+
+    FlatNode() = default;
+
+    Type GetType() const {
+        return type_;
+    }
+
+    bool IsNull() const {
+        return type_ == Type::NULL_VALUE;
+    }
+    bool IsBool() const {
+        return type_ == Type::BOOL;
+    }
+    bool IsInt() const {
+        return type_ == Type::INT;
+    }
+    bool IsPureDouble() const {
+        return type_ == Type::DOUBLE;
+    }
+    bool IsDouble() const {
+        return IsInt() || IsPureDouble();
+    }
+    bool IsString() const {
+        return type_ == Type::STRING;
+    }
+    bool IsArray() const {
+        return type_ == Type::ARRAY;
+    }
+    bool IsDict() const {
+        return type_ == Type::DICT;
+    }
+
+    bool AsBool() const;
+    int AsInt() const;
+    double AsDouble() const;
+    std::string_view AsString() const;
+    ranges::Range<const FlatNode*> AsArray() const;
+    ranges::Range<const FlatMember*> AsDict() const;
+
+    // Число элементов массива или пар словаря
+    size_t Size() const;
+    // Элемент массива
+    const FlatNode& operator[](size_t index) const;
+    // Значение словаря по ключу (двоичный поиск) или nullptr
+    const FlatNode* Find(std::string_view key) const;
+    // Значение словаря по ключу; std::out_of_range, если ключа нет
+    const FlatNode& At(std::string_view key) const;
+
+    // Копия узла в виде дерева json::Node
+    Node ToNode() const;
+
+private:
+    friend class FlatBuilder;
+
+    Type type_ = Type::NULL_VALUE;
+    // Длина строки или число элементов
+    uint32_t size_ = 0;
+    union {
+        bool bool_;
+        int int_;
+        double double_ = 0.;
+        const char* chars_;
+        const FlatNode* items_;
+        const FlatMember* members_;
+    };
+};
+
+struct FlatMember {
+    std::string_view key;
+    FlatNode value;
+};
+
+class FlatDocument {
+public:
+    // Буфер input должен жить не меньше документа
+    explicit FlatDocument(std::string_view input);
+
+    const FlatNode& GetRoot() const {
+        return root_;
+    }
+
+private:
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena_;
+    FlatNode root_;
+};
+
+}  // namespace json
@@ -1,7 +1,12 @@
 #include "json_reader.h"
-#include <sstream>
+#include "json_binding.h"
+#include "json_writer.h"
+
+#include <algorithm>
 #include <variant>
 #include <memory>
+#include <limits>
+#include <unordered_set>
 
 /*
  * Здесь можно разместить код наполнения транспортного справочника данными из JSON,
@@ -10,278 +15,575 @@
 using namespace std::literals;
 
 namespace io {
-    std::tuple<std::vector<std::string>, std::vector<std::string>, size_t> ParseRoute(const json::Node stops_node, bool is_roundtrip) {
-        std::vector<std::string> route;
-        std::vector<std::string> end_points;
-        size_t end_point_idx = 0;
-        const auto& stops_list = stops_node.AsArray();
-        route.reserve(stops_list.size());
-        for (const auto& stop : stops_list) {
-            route.push_back(stop.AsString());
-        }
-        if (!route.empty()) {
-            end_points = is_roundtrip ? std::vector<std::string>{route.front()}
-            : std::vector<std::string>{ route.front(), route.back() };
-            end_point_idx = route.size() - 1;
-        }
-        if (!is_roundtrip) {
-            std::vector<std::string> results(route.begin(), route.end());
-            results.insert(results.end(), std::next(route.rbegin()), route.rend());
-            return { results, end_points, end_point_idx };
-        }
-        return { route, end_points, end_point_idx };
-    }
+    namespace {
 
-    void JsonReader::ApplyBaseRequests(model::TransportCatalogue& catalogue) const {
-        using namespace json;
-        std::vector<size_t> commands_stop;
-        std::vector<size_t> commands_bus;
-        //--
-        auto root = doc_.GetRoot().AsDict();
-        auto base_requests = root.at("base_requests");
-        size_t command_idx = 0;
-        const auto& base_list = base_requests.AsArray();
-        for (const auto& base : base_list) {
-            const auto& base_obj = base.AsDict();
-            std::string type = base_obj.at("type").AsString();
-            if (type == "Stop") {
-                geo::Coordinates coord = { base_obj.at("latitude").AsDouble(), base_obj.at("longitude").AsDouble() };
-                catalogue.AddStop(base_obj.at("name").AsString(), coord);
-                commands_stop.push_back(command_idx++);
+        // Базовый запрос: поля остановки и автобуса вместе, нужные проверяются по type
+        struct BaseRequest {
+            std::string type;
+            std::string_view name;
+            double latitude = 0.;
+            double longitude = 0.;
+            json::Entries<double> road_distances;
+            std::vector<std::string_view> stops;
+            bool is_roundtrip = false;
+        };
+
+        // Названия переносятся в арену один раз, повторные ссылки получают тот же view
+        class NameStore final : public json::StringStore {
+        public:
+            explicit NameStore(model::StringArena& arena)
+                : arena_(arena) {
             }
-            else
-            {
-                commands_bus.push_back(command_idx++);
+
+            std::string_view Store(std::string_view str) override {
+                if (auto it = stored_.find(str); it != stored_.end()) {
+                    return *it;
+                }
+                return *stored_.insert(arena_.Append(str)).first;
+            }
+
+        private:
+            model::StringArena& arena_;
+            std::unordered_set<std::string_view> stored_;
+        };
+
+    }  // namespace
+}
+
+namespace json {
+
+    template <>
+    struct ObjectBinding<io::BaseRequest> {
+        using T = io::BaseRequest;
+        static constexpr auto FIELDS = std::make_tuple(
+            Field{ "type"sv, &T::type },
+            Field{ "name"sv, &T::name, false },
+            Field{ "latitude"sv, &T::latitude, false },
+            Field{ "longitude"sv, &T::longitude, false },
+            Field{ "road_distances"sv, &T::road_distances, false },
+            Field{ "stops"sv, &T::stops, false },
+            Field{ "is_roundtrip"sv, &T::is_roundtrip, false });
+    };
+
+    template <>
+    struct Codec<model::BaseRequestBatch> {
+        static void Decode(Decoder& decoder, model::BaseRequestBatch& batch) {
+            decoder.Expect(Reader::Token::ARRAY);
+            Reader& reader = decoder.GetReader();
+            reader.StartArray();
+            for (size_t index = 0; reader.NextItem(); ++index) {
+                decoder.PushIndex(index);
+                io::BaseRequest request;
+                const FieldMask seen = DecodeObject(decoder, request);
+                if (request.type == "Stop"sv) {
+                    RequireFields<io::BaseRequest>(decoder, seen, { "name"sv, "latitude"sv, "longitude"sv, "road_distances"sv });
+                    batch.stops.push_back({ request.name, { request.latitude, request.longitude }, std::move(request.road_distances.items) });
+                }
+                else if (request.type == "Bus"sv) {
+                    RequireFields<io::BaseRequest>(decoder, seen, { "name"sv, "stops"sv, "is_roundtrip"sv });
+                    batch.buses.push_back({ request.name, std::move(request.stops), request.is_roundtrip });
+                }
+                decoder.Pop();
             }
         }
+    };
 
-        for (size_t idx : commands_stop) {
-            const auto& base = base_list[idx];
-            const auto& base_obj = base.AsDict();
-            const auto& road_distances = base_obj.at("road_distances").AsDict();
-            for (const auto& [to_stop, dist] : road_distances) {
-                catalogue.SetStopsDistance(base_obj.at("name").AsString(), to_stop, dist.AsDouble());
+    // Цвет: строка, [r, g, b] или [r, g, b, opacity]
+    template <>
+    struct Codec<svg::Color> {
+        static void Decode(Decoder& decoder, svg::Color& color) {
+            if (decoder.GetReader().Peek() == Reader::Token::STRING) {
+                color = std::string(decoder.GetReader().ReadString());
+                return;
+            }
+            std::vector<double> components;
+            Codec<std::vector<double>>::Decode(decoder, components);
+            if (components.size() == 3) {
+                color = svg::Rgb{ ToByte(components[0]), ToByte(components[1]), ToByte(components[2]) };
+            }
+            else if (components.size() == 4) {
+                color = svg::Rgba{ ToByte(components[0]), ToByte(components[1]), ToByte(components[2]), components[3] };
+            }
+            else {
+                decoder.Fail("expected color as string or array of 3 or 4 numbers");
             }
         }
 
-        for (size_t idx : commands_bus) {
-            const auto& base = base_list[idx];
-            const auto& base_obj = base.AsDict();
-            std::string type = base_obj.at("type").AsString();
-            if (type == "Bus") {
-                json::Node stops_node = base_obj.at("stops");
-                bool is_roundtrip = base_obj.at("is_roundtrip").AsBool();
-                auto [route, end_points, end_point_idx] = ParseRoute(stops_node, is_roundtrip);
+    private:
+        static uint8_t ToByte(double value) {
+            return static_cast<uint8_t>(static_cast<int>(value));
+        }
+    };
+
+    template <>
+    struct ObjectBinding<renderer::RenderSettings> {
+        using T = renderer::RenderSettings;
+        static constexpr auto FIELDS = std::make_tuple(
+            Field{ "width"sv, &T::width },
+            Field{ "height"sv, &T::height },
+            Field{ "padding"sv, &T::padding },
+            Field{ "line_width"sv, &T::line_width },
+            Field{ "stop_radius"sv, &T::stop_radius },
+            Field{ "bus_label_font_size"sv, &T::bus_label_font_size },
+            Field{ "bus_label_offset"sv, &T::bus_label_offset },
+            Field{ "stop_label_font_size"sv, &T::stop_label_font_size },
+            Field{ "stop_label_offset"sv, &T::stop_label_offset },
+            Field{ "underlayer_color"sv, &T::underlayer_color },
+            Field{ "underlayer_width"sv, &T::underlayer_width },
+            Field{ "color_palette"sv, &T::color_palette });
+    };
 
-                catalogue.AddBus(base_obj.at("name").AsString(), route, end_points, is_roundtrip, end_point_idx);
+    template <>
+    struct ObjectBinding<routing::RoutingSettings> {
+        using T = routing::RoutingSettings;
+        static constexpr auto FIELDS = std::make_tuple(
+            Field{ "bus_wait_time"sv, &T::bus_wait_time },
+            Field{ "bus_velocity"sv, &T::bus_velocity },
+            Field{ "walk_radius"sv, &T::walk_radius, false },
+            Field{ "walk_velocity"sv, &T::walk_velocity, false });
+    };
+
+    // Скорости задаются в км/ч, маршрутизатор считает в м/мин
+    template <>
+    struct Codec<routing::RoutingSettings> {
+        static void Decode(Decoder& decoder, routing::RoutingSettings& settings) {
+            auto meter_per_min = [](double km_per_hour) { return 1'000. * km_per_hour / 60.; };
+            const FieldMask seen = DecodeObject(decoder, settings);
+            if (HasField<routing::RoutingSettings>(seen, "walk_radius"sv)) {
+                RequireFields<routing::RoutingSettings>(decoder, seen, { "walk_velocity"sv });
             }
+            settings.bus_velocity = meter_per_min(settings.bus_velocity);
+            settings.walk_velocity = meter_per_min(settings.walk_velocity);
         }
-    }
+    };
+
+    template <>
+    struct ObjectBinding<serialization::SerializationSettings> {
+        using T = serialization::SerializationSettings;
+        static constexpr auto FIELDS = std::make_tuple(
+            Field{ "file"sv, &T::file },
+            Field{ "journal"sv, &T::journal, false },
+            Field{ "journal_compaction_threshold"sv, &T::journal_compaction_threshold, false });
+    };
+
+    template <>
+    struct ObjectBinding<io::StatRequest> {
+        using T = io::StatRequest;
+        static constexpr auto FIELDS = std::make_tuple(
+            Field{ "id"sv, &T::id },
+            Field{ "type"sv, &T::type },
+            Field{ "name"sv, &T::name, false },
+            Field{ "from"sv, &T::from, false },
+            Field{ "to"sv, &T::to, false },
+            Field{ "latitude"sv, &T::latitude, false },
+            Field{ "longitude"sv, &T::longitude, false },
+            Field{ "radius"sv, &T::radius, false },
+            Field{ "count"sv, &T::count, false },
+            Field{ "prefix"sv, &T::prefix, false },
+            Field{ "by_bus_count"sv, &T::by_bus_count, false });
+    };
 
-    svg::Color ParseColor(json::Node color_node) {
-        if (color_node.IsString()) {
-            return color_node.AsString();
-        }
-        if (color_node.IsArray()) {
-            auto color_list = color_node.AsArray();
-            if (color_list.size() == 3) {
-                return svg::Rgb{
-                    static_cast<uint8_t>(color_list.at(0).AsInt()),
-                    static_cast<uint8_t>(color_list.at(1).AsInt()),
-                    static_cast<uint8_t>(color_list.at(2).AsInt()) 
-                };
+    template <>
+    struct Codec<io::StatRequest> {
+        static void Decode(Decoder& decoder, io::StatRequest& request) {
+            const FieldMask seen = DecodeObject(decoder, request);
+            if (request.type == "NearbyStops"sv) {
+                RequireFields<io::StatRequest>(decoder, seen, { "latitude"sv, "longitude"sv });
+            }
+            else if (request.type == "StopSuggest"sv) {
+                RequireFields<io::StatRequest>(decoder, seen, { "prefix"sv });
             }
-            if (color_list.size() == 4) {
-                return svg::Rgba{
-                    static_cast<uint8_t>(color_list.at(0).AsInt()),
-                    static_cast<uint8_t>(color_list.at(1).AsInt()),
-                    static_cast<uint8_t>(color_list.at(2).AsInt()),
-                    color_list.at(3).AsDouble()
-                };
+            else if (request.type == "DirectBuses"sv || request.type == "Route"sv) {
+                RequireFields<io::StatRequest>(decoder, seen, { "from"sv, "to"sv });
             }
         }
-        return svg::Color();
+    };
+
+    template <>
+    struct Codec<OutputFormat> {
+        static void Decode(Decoder& decoder, OutputFormat& format) {
+            decoder.Expect(Reader::Token::STRING);
+            try {
+                format = ParseOutputFormat(decoder.GetReader().ReadString());
+            }
+            catch (const std::invalid_argument& error) {
+                decoder.Fail(error.what());
+            }
+        }
+    };
+
+    template <>
+    struct ObjectBinding<io::Requests> {
+        using T = io::Requests;
+        static constexpr auto FIELDS = std::make_tuple(
+            Field{ "base_requests"sv, &T::base_requests, false },
+            Field{ "output_format"sv, &T::output_format, false },
+            Field{ "render_settings"sv, &T::render_settings, false },
+            Field{ "routing_settings"sv, &T::routing_settings, false },
+            Field{ "serialization_settings"sv, &T::serialization_settings, false },
+            Field{ "stat_requests"sv, &T::stat_requests, false });
+    };
+
+}
+
+namespace io {
+    JsonReader::JsonReader(std::istream& input) {
+        NameStore store(names_);
+        json::Decode(input, requests_, &store);
+    }
+
+    JsonReader::JsonReader(std::string_view input) {
+        NameStore store(names_);
+        json::Decode(input, requests_, &store);
+    }
+
+    void JsonReader::ApplyBaseRequests(model::TransportCatalogue& catalogue) const {
+        if (!requests_.base_requests) {
+            throw std::logic_error("ApplyBaseRequests: base_requests are not set"s);
+        }
+        catalogue.BulkLoad(*requests_.base_requests);
     }
 
-    renderer::RenderSettings JsonReader::ParseRenderSettings() const {
-        using namespace json;
-        renderer::RenderSettings render_settings;
-        auto root = doc_.GetRoot().AsDict();
-        auto settings_obj = root.at("render_settings").AsDict();
-        render_settings.width = settings_obj.at("width").AsDouble();
-        render_settings.height = settings_obj.at("height").AsDouble();
-        render_settings.padding = settings_obj.at("padding").AsDouble();
-        render_settings.line_width = settings_obj.at("line_width").AsDouble();
-        render_settings.stop_radius = settings_obj.at("stop_radius").AsDouble();
-        render_settings.bus_label_font_size = settings_obj.at("bus_label_font_size").AsInt();
-        render_settings.bus_label_offset = std::make_pair(settings_obj.at("bus_label_offset").AsArray().at(0).AsDouble(),
-            settings_obj.at("bus_label_offset").AsArray().at(1).AsDouble());
-        render_settings.stop_label_font_size = settings_obj.at("stop_label_font_size").AsInt();
-        render_settings.stop_label_offset = std::make_pair(settings_obj.at("stop_label_offset").AsArray().at(0).AsDouble(),
-            settings_obj.at("stop_label_offset").AsArray().at(1).AsDouble());
-        render_settings.underlayer_color = ParseColor(settings_obj.at("underlayer_color"));
-        render_settings.underlayer_width = settings_obj.at("underlayer_width").AsDouble();
-
-        auto color_palette_list = settings_obj.at("color_palette").AsArray();
-        for (const auto& color : color_palette_list) {
-            render_settings.color_palette.push_back(ParseColor(color));
-        }
-
-        return render_settings;
+    const renderer::RenderSettings& JsonReader::ParseRenderSettings() const {
+        if (!requests_.render_settings) {
+            throw std::logic_error("render_settings are not set"s);
+        }
+        return *requests_.render_settings;
     }
 
-    routing::RoutingSettings JsonReader::ParseRoutingSettings() const
+    const routing::RoutingSettings& JsonReader::ParseRoutingSettings() const
     {
-        using namespace json;
-        auto meter_per_min = [](double km_per_hour) { return 1'000. * km_per_hour / 60.; };
-        routing::RoutingSettings routing_settings;
-        auto root = doc_.GetRoot().AsDict();
-        auto settings_obj = root.at("routing_settings").AsDict();
-        routing_settings.bus_wait_time = settings_obj.at("bus_wait_time").AsInt();
-        routing_settings.bus_velocity = meter_per_min(settings_obj.at("bus_velocity").AsDouble());
-        return routing_settings;
+        if (!requests_.routing_settings) {
+            throw std::logic_error("routing_settings are not set"s);
+        }
+        return *requests_.routing_settings;
     }
 
-    //-----------------------
-    std::string Print(const json::Node& node) {
-        std::ostringstream out;
-        Print(json::Document{ node }, out);
-        return out.str();
+    const serialization::SerializationSettings& JsonReader::ParseSerializationSettings() const
+    {
+        if (!requests_.serialization_settings) {
+            throw std::logic_error("serialization_settings are not set"s);
+        }
+        return *requests_.serialization_settings;
     }
 
+    //-----------------------
+    //--ключи выводятся в лексикографическом порядке, как их упорядочил бы json::Dict
     void PrintBusStat(const model::TransportCatalogue& transport_catalogue, int id,
-        std::string_view name, json::Builder& builder) {
-        builder.StartDict();
-        builder.Key("request_id").Value(id);
-        if (auto info = transport_catalogue.GetRouteInfoByBusName(std::string(name)); info.has_value()) {
-            builder.Key("curvature").Value(info->curvature);
-            builder.Key("route_length").Value(info->length);
-            builder.Key("stop_count").Value(static_cast<int>(info->stop_count));
-            builder.Key("unique_stop_count").Value(static_cast<int>(info->unique_stop_count));
+        std::string_view name, json::Writer& writer) {
+        writer.StartDict();
+        if (auto info = transport_catalogue.GetRouteInfoByBusName(name); info.has_value()) {
+            writer.Key("curvature"sv).Value(info->curvature);
+            writer.Key("request_id"sv).Value(id);
+            writer.Key("route_length"sv).Value(info->length);
+            writer.Key("stop_count"sv).Value(static_cast<int>(info->stop_count));
+            writer.Key("unique_stop_count"sv).Value(static_cast<int>(info->unique_stop_count));
         }
         else
         {
-            builder.Key("error_message"s).Value("not found"s);
+            writer.Key("error_message"sv).Value("not found"sv);
+            writer.Key("request_id"sv).Value(id);
         }
-        builder.EndDict();
+        writer.EndDict();
     }
 
     void PrintStopStat(const model::TransportCatalogue& transport_catalogue, int id,
-        std::string_view name, json::Builder& builder) {
-        builder.StartDict();
-        builder.Key("request_id"s).Value(id);
-        if (auto buses = transport_catalogue.GetBusesByStop(name); buses.has_value()) {            
-            builder.Key("buses"s).StartArray();           
+        std::string_view name, json::Writer& writer) {
+        writer.StartDict();
+        if (auto buses = transport_catalogue.GetBusesByStop(name); buses.has_value()) {
+            writer.Key("buses"sv).StartArray();
             for (const auto& bus_name : buses.value()) {
-                builder.Value(std::string(bus_name));
+                writer.Value(bus_name);
             }
-            builder.EndArray();
+            writer.EndArray();
         }
         else
         {
-            builder.Key("error_message"s).Value("not found"s);
+            writer.Key("error_message"sv).Value("not found"sv);
         }
-        builder.EndDict();
+        writer.Key("request_id"sv).Value(id);
+        writer.EndDict();
     }
 
-    void PrintMapStat(const renderer::MapRenderer& map_renderer, int id, json::Builder& builder) {
-        builder.StartDict();
-        builder.Key("request_id"s).Value(id);
-        std::ostringstream oss;
-        map_renderer.RenderMap().Render(oss);
-        std::string map_str = oss.str();
-        builder.Key("map"s).Value(map_str);
-        builder.EndDict();
+    void PrintMapStat(const renderer::MapRenderer& map_renderer, int id, json::Writer& writer) {
+        writer.StartDict();
+        //--SVG выводится прямо в строку ответа, без промежуточных копий
+        writer.Key("map"sv).StringValue([&map_renderer](std::ostream& out) {
+            map_renderer.RenderMap().Render(out);
+        });
+        writer.Key("request_id"sv).Value(id);
+        writer.EndDict();
     }
 
     struct RouteItemVisitor {
-        json::Builder& json;
+        json::Writer& json;
 
         void operator()(const routing::WaitItem& response) const {
-            json.Key("type"s).Value(response.type);
-            json.Key("stop_name"s).Value(response.stop_name);
-            json.Key("time"s).Value(response.time);
+            json.Key("stop_name"sv).Value(response.stop_name);
+            json.Key("time"sv).Value(response.time);
+            json.Key("type"sv).Value(response.type);
         }
         void operator()(const routing::BusItem& response) const {
-            json.Key("type"s).Value(response.type);
-            json.Key("bus").Value(response.bus_name);
-            json.Key("span_count"s).Value(response.span_count);
-            json.Key("time"s).Value(response.time);
+            json.Key("bus"sv).Value(response.bus_name);
+            json.Key("span_count"sv).Value(response.span_count);
+            json.Key("time"sv).Value(response.time);
+            json.Key("type"sv).Value(response.type);
+        }
+        void operator()(const routing::WalkItem& response) const {
+            json.Key("from"sv).Value(response.from);
+            json.Key("time"sv).Value(response.time);
+            json.Key("to"sv).Value(response.to);
+            json.Key("type"sv).Value(response.type);
         }
     };
 
-    void PrintRouteStat(const routing::ResponseData& router_data, int id, json::Builder& builder) {
-        builder.StartDict();
-        builder.Key("request_id"s).Value(id);
-        builder.Key("total_time"s).Value(router_data.total_time);
-        builder.Key("items"s).StartArray();
+    void PrintRouteStat(const routing::ResponseData& router_data, int id, json::Writer& writer) {
+        writer.StartDict();
+        writer.Key("items"sv).StartArray();
         for (const auto& item : router_data.items) {
-            builder.StartDict();
-            std::visit(RouteItemVisitor{ builder }, item);
-            builder.EndDict();
+            writer.StartDict();
+            std::visit(RouteItemVisitor{ writer }, item);
+            writer.EndDict();
+        }
+        writer.EndArray();
+        writer.Key("request_id"sv).Value(id);
+        writer.Key("total_time"sv).Value(router_data.total_time);
+        writer.EndDict();
+    }
+
+    void PrintNearbyStopsStat(const model::TransportCatalogue& transport_catalogue, int id,
+        const StatRequest& request, json::Writer& writer) {
+        geo::Coordinates center = { request.latitude, request.longitude };
+        double radius = request.radius.value_or(std::numeric_limits<double>::infinity());
+        size_t count = std::numeric_limits<size_t>::max();
+        if (request.count) {
+            count = static_cast<size_t>(std::max(0, *request.count));
+        }
+
+        writer.StartDict();
+        writer.Key("request_id"sv).Value(id);
+        writer.Key("stops"sv).StartArray();
+        for (const auto& [stop, distance] : transport_catalogue.FindNearbyStops(center, radius, count)) {
+            writer.StartDict();
+            writer.Key("distance"sv).Value(distance);
+            writer.Key("name"sv).Value(stop->name);
+            writer.EndDict();
+        }
+        writer.EndArray();
+        writer.EndDict();
+    }
+
+    void PrintDirectBusesStat(const model::TransportCatalogue& transport_catalogue, int id,
+        std::string_view from, std::string_view to, json::Writer& writer) {
+        writer.StartDict();
+        if (auto buses = transport_catalogue.GetDirectBuses(from, to); buses.has_value()) {
+            writer.Key("buses"sv).StartArray();
+            for (const model::Bus* bus : *buses) {
+                writer.Value(bus->name);
+            }
+            writer.EndArray();
+        }
+        else
+        {
+            writer.Key("error_message"sv).Value("not found"sv);
+        }
+        writer.Key("request_id"sv).Value(id);
+        writer.EndDict();
+    }
+
+    void PrintStopSuggestStat(const model::TransportCatalogue& transport_catalogue, int id,
+        const StatRequest& request, json::Writer& writer) {
+        const size_t count = static_cast<size_t>(std::max(0, request.count.value_or(10)));
+
+        writer.StartDict();
+        writer.Key("request_id"sv).Value(id);
+        writer.Key("stops"sv).StartArray();
+        for (const auto& [stop, bus_count] : transport_catalogue.SuggestStops(request.prefix, count, request.by_bus_count)) {
+            writer.StartDict();
+            writer.Key("bus_count"sv).Value(static_cast<int>(bus_count));
+            writer.Key("name"sv).Value(stop->name);
+            writer.EndDict();
+        }
+        writer.EndArray();
+        writer.EndDict();
+    }
+
+    // Размеры в байтах выводятся целыми, пока помещаются в int
+    void WriteSize(size_t size, json::Writer& writer) {
+        if (size <= static_cast<size_t>(std::numeric_limits<int>::max())) {
+            writer.Value(static_cast<int>(size));
+        }
+        else {
+            writer.Value(static_cast<double>(size));
+        }
+    }
+
+    void PrintMemoryReport(const model::MemoryReport& report, json::Writer& writer) {
+        std::vector<const model::MemoryUsage*> structures;
+        structures.reserve(report.structures.size());
+        for (const auto& usage : report.structures) {
+            structures.push_back(&usage);
+        }
+        std::sort(structures.begin(), structures.end(), [](const model::MemoryUsage* lhs, const model::MemoryUsage* rhs) {
+            return lhs->structure < rhs->structure;
+        });
+
+        writer.StartDict();
+        writer.Key("arena_bytes"sv);
+        WriteSize(report.arena_bytes, writer);
+        writer.Key("structures"sv).StartDict();
+        for (const model::MemoryUsage* usage : structures) {
+            writer.Key(usage->structure).StartDict();
+            writer.Key("bytes"sv);
+            WriteSize(usage->bytes, writer);
+            writer.Key("elements"sv);
+            WriteSize(usage->elements, writer);
+            writer.EndDict();
+        }
+        writer.EndDict();
+        writer.Key("total_bytes"sv);
+        WriteSize(report.TotalBytes(), writer);
+        writer.EndDict();
+    }
+
+    void PrintMemoryStat(const model::TransportCatalogue& transport_catalogue, const renderer::MapRenderer* map_renderer,
+        const routing::TransportRouter* router, int id, json::Writer& writer) {
+        const model::MemoryReport catalogue_report = transport_catalogue.GetMemoryReport();
+        size_t total_bytes = catalogue_report.TotalBytes();
+        std::optional<model::MemoryReport> renderer_report;
+        if (map_renderer) {
+            renderer_report = map_renderer->GetMemoryReport();
+            total_bytes += renderer_report->TotalBytes();
+        }
+        std::optional<model::MemoryReport> router_report;
+        if (router) {
+            router_report = router->GetMemoryReport();
+            total_bytes += router_report->TotalBytes();
+        }
+
+        writer.StartDict();
+        writer.Key("catalogue"sv);
+        PrintMemoryReport(catalogue_report, writer);
+        if (renderer_report) {
+            writer.Key("renderer"sv);
+            PrintMemoryReport(*renderer_report, writer);
         }
-        builder.EndArray();
-        builder.EndDict();
+        writer.Key("request_id"sv).Value(id);
+        if (router_report) {
+            writer.Key("router"sv);
+            PrintMemoryReport(*router_report, writer);
+        }
+        writer.Key("total_bytes"sv);
+        WriteSize(total_bytes, writer);
+        writer.EndDict();
     }
 
-    void PrintErrorMessage(int request_id, json::Builder& builder) {
-        builder.StartDict();
-        builder.Key("request_id"s).Value(request_id);
-        builder.Key("error_message"s).Value("not found"s);
-        builder.EndDict();
+    void PrintErrorMessage(int request_id, json::Writer& writer) {
+        writer.StartDict();
+        writer.Key("error_message"sv).Value("not found"sv);
+        writer.Key("request_id"sv).Value(request_id);
+        writer.EndDict();
     }
 
     void JsonReader::ApplyStatRequests(const model::TransportCatalogue& catalogue) const {
-        using namespace json;
-        //----
-        std::optional<renderer::RenderSettings> render_settings;
-        std::optional <routing::RoutingSettings> routing_settings;
+        //--настройки берутся по ссылке из разобранного документа, без копий
         std::unique_ptr<renderer::MapRenderer> map_renderer = nullptr;
         std::unique_ptr<routing::TransportRouter> router = nullptr;
-        //----
-        auto root = doc_.GetRoot().AsDict();
-        auto stat_requests = root.at("stat_requests");
-        auto builder = json::Builder();
-        builder.StartArray();
-        for (const auto& stat : stat_requests.AsArray()) {
-            auto stat_obj = stat.AsDict();
-            int id = stat_obj.at("id").AsInt();
-            std::string name;
-            if (stat_obj.count("name")) {
-				name = stat_obj.at("name").AsString();
+
+        auto get_renderer = [&]() -> const renderer::MapRenderer& {
+            if (!map_renderer) {
+                map_renderer = std::make_unique<renderer::MapRenderer>(catalogue, ParseRenderSettings());
+            }
+            return *map_renderer;
+        };
+        auto get_router = [&]() -> const routing::TransportRouter& {
+            if (!router) {
+                router = std::make_unique<routing::TransportRouter>(catalogue, ParseRoutingSettings());
+            }
+            return *router;
+        };
+        ApplyStatRequests(catalogue, get_renderer, get_router);
+    }
+
+    void JsonReader::SetDefaultOutputFormat(json::OutputFormat format) {
+        default_output_format_ = format;
+    }
+
+    std::unique_ptr<handler::CatalogueVersion> JsonReader::MakeCatalogueVersion() const {
+        auto catalogue = std::make_unique<model::TransportCatalogue>();
+        ApplyBaseRequests(*catalogue);
+        return MakeCatalogueVersion(std::move(catalogue));
+    }
+
+    std::unique_ptr<handler::CatalogueVersion> JsonReader::MakeCatalogueVersion(std::unique_ptr<model::TransportCatalogue> catalogue) const {
+        return handler::BuildCatalogueVersion(std::move(catalogue), requests_.render_settings, requests_.routing_settings);
+    }
+
+    void JsonReader::ApplyStatRequests(const handler::CatalogueVersion& version) const {
+        auto get_renderer = [&]() -> const renderer::MapRenderer& {
+            const renderer::MapRenderer* map_renderer = version.GetRenderer();
+            if (!map_renderer) {
+                throw std::logic_error("ApplyStatRequests: catalogue version has no render_settings");
             }
-            std::string type = stat_obj.at("type").AsString();
+            return *map_renderer;
+        };
+        auto get_router = [&]() -> const routing::TransportRouter& {
+            const routing::TransportRouter* router = version.GetRouter();
+            if (!router) {
+                throw std::logic_error("ApplyStatRequests: catalogue version has no routing_settings");
+            }
+            return *router;
+        };
+        ApplyStatRequests(version.GetCatalogue(), get_renderer, get_router);
+    }
+
+    void JsonReader::ApplyStatRequests(const model::TransportCatalogue& catalogue,
+        const RendererGetter& get_renderer, const RouterGetter& get_router) const {
+        using namespace json;
+        //----
+        if (!requests_.stat_requests) {
+            throw std::logic_error("stat_requests are not set"s);
+        }
+        //--каждый ответ пишется сразу после вычисления, дерево ответов не строится
+        json::Writer writer(std::cout, requests_.output_format.value_or(default_output_format_));
+        writer.StartArray();
+        for (const StatRequest& request : *requests_.stat_requests) {
+            const int id = request.id;
+            const std::string& name = request.name;
+            const std::string& type = request.type;
 
             if (type == "Bus") {
-                PrintBusStat(catalogue, id, name, builder);                
+                PrintBusStat(catalogue, id, name, writer);                
             }
             if (type == "Stop") {
-                PrintStopStat(catalogue, id, name, builder);
+                PrintStopStat(catalogue, id, name, writer);
+            }
+            if (type == "NearbyStops") {
+                PrintNearbyStopsStat(catalogue, id, request, writer);
+            }
+            if (type == "StopSuggest") {
+                PrintStopSuggestStat(catalogue, id, request, writer);
+            }
+            if (type == "DirectBuses") {
+                PrintDirectBusesStat(catalogue, id, request.from, request.to, writer);
             }
             if (type == "Map") {
-                if (!render_settings.has_value()) {
-                    render_settings = ParseRenderSettings();
-                    map_renderer = std::make_unique<renderer::MapRenderer>(catalogue, *render_settings);
-                }
-                PrintMapStat(*map_renderer, id, builder);
+                PrintMapStat(get_renderer(), id, writer);
+            }
+            if (type == "MemoryStats") {
+                PrintMemoryStat(catalogue, requests_.render_settings ? &get_renderer() : nullptr,
+                    requests_.routing_settings ? &get_router() : nullptr, id, writer);
             }
             if (type == "Route") {
-                const auto& from = stat_obj.at("from").AsString();
-                const auto& to = stat_obj.at("to").AsString();
-                if (!routing_settings.has_value()) {
-                    routing_settings = ParseRoutingSettings();
-                    router = std::make_unique<routing::TransportRouter>(catalogue, *routing_settings);
-                }                
-                if (auto route_data = router->BuildRoute(from, to)) {
-                    PrintRouteStat(*route_data, id, builder);
+                if (auto route_data = get_router().BuildRoute(request.from, request.to)) {
+                    PrintRouteStat(*route_data, id, writer);
                 }
                 else
                 {
-                    PrintErrorMessage(id, builder);
+                    PrintErrorMessage(id, writer);
                 }
             }
         }
-        builder.EndArray();
-		Print(json::Document{ builder.Build() }, std::cout);
+        writer.EndArray();
     }
 }
@@ -2,10 +2,17 @@
 
 #include "json.h"
 #include "json_builder.h"
+#include "json_writer.h"
 #include "map_renderer.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
 #include "request_handler.h"
+#include "catalogue_snapshot.h"
+#include "string_arena.h"
+
+#include <functional>
+#include <memory>
+#include <optional>
 
 
 /*
@@ -16,30 +23,72 @@
 
 namespace io {
 
-    /**
-     * Парсит маршрут.
-     * Для кольцевого маршрута (A>B>C>A) возвращает массив названий остановок [A,B,C,A]
-     * Для некольцевого маршрута (A-B-C-D) возвращает массив названий остановок [A,B,C,D,C,B,A]
-     * Возвращает маршрут и конечные точки маршрута
-     */
-    std::tuple<std::vector<std::string>, std::vector<std::string>, size_t> ParseRoute(const json::Node stops_node, bool is_roundtrip);
+    // Запрос из stat_requests; поля, не относящиеся к его типу, остаются пустыми
+    struct StatRequest {
+        int id = 0;
+        std::string type;
+        std::string name;
+        std::string from;
+        std::string to;
+        double latitude = 0.;
+        double longitude = 0.;
+        std::optional<double> radius;
+        std::optional<int> count;
+        std::string prefix;
+        bool by_bus_count = false;
+    };
 
+    // Содержимое входного документа; отсутствующие разделы остаются пустыми
+    struct Requests {
+        std::optional<model::BaseRequestBatch> base_requests;
+        std::optional<renderer::RenderSettings> render_settings;
+        std::optional<routing::RoutingSettings> routing_settings;
+        std::optional<serialization::SerializationSettings> serialization_settings;
+        std::optional<std::vector<StatRequest>> stat_requests;
+        // Формат ответов на stat_requests этого документа: "json", "compact" или "cbor"
+        std::optional<json::OutputFormat> output_format;
+    };
 
+    /**
+     * Читает запросы за один проход прямо в структуры C++ (json_binding.h), без дерева Node.
+     * Названия остановок и автобусов из base_requests хранятся в собственной арене строк
+     */
     class JsonReader {
     public:
-        explicit JsonReader(std::istream& input)
-            : doc_(json::Load(input)) {
-        }
+        explicit JsonReader(std::istream& input);
+        // Разбирает документ прямо из буфера (например, отображённого в память файла);
+        // после конструирования буфер больше не нужен
+        explicit JsonReader(std::string_view input);
 
         void ApplyBaseRequests(model::TransportCatalogue& catalogue) const;
 
-        renderer::RenderSettings ParseRenderSettings() const;
-        routing::RoutingSettings ParseRoutingSettings() const;
+        // Настройки из документа; ссылки действительны, пока жив читатель
+        const renderer::RenderSettings& ParseRenderSettings() const;
+        const routing::RoutingSettings& ParseRoutingSettings() const;
+        const serialization::SerializationSettings& ParseSerializationSettings() const;
 
         void ApplyStatRequests(const model::TransportCatalogue& catalogue) const;
 
+        // Формат ответов, если документ не задаёт свой output_format
+        void SetDefaultOutputFormat(json::OutputFormat format);
+
+        // Строит новую версию справочника по base_requests вместе с маршрутизатором и визуализатором
+        std::unique_ptr<handler::CatalogueVersion> MakeCatalogueVersion() const;
+        // Строит версию вокруг уже заполненного справочника (например, восстановленного из снимка)
+        std::unique_ptr<handler::CatalogueVersion> MakeCatalogueVersion(std::unique_ptr<model::TransportCatalogue> catalogue) const;
+        // Отвечает на stat_requests по захваченной версии, не перестраивая производные структуры
+        void ApplyStatRequests(const handler::CatalogueVersion& version) const;
+
     private:
-        json::Document doc_;
+        using RendererGetter = std::function<const renderer::MapRenderer& ()>;
+        using RouterGetter = std::function<const routing::TransportRouter& ()>;
+
+        void ApplyStatRequests(const model::TransportCatalogue& catalogue,
+            const RendererGetter& get_renderer, const RouterGetter& get_router) const;
+
+        model::StringArena names_;
+        Requests requests_;
+        json::OutputFormat default_output_format_ = json::OutputFormat::PRETTY;
     };
 
 
@@ -0,0 +1,469 @@
+#include "json_writer.h"
+#include "swar.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <streambuf>
+#include <variant>
+
+using namespace std::literals;
+
+namespace json {
+
+namespace {
+
+// Старшие типы CBOR
+constexpr uint8_t CBOR_UNSIGNED = 0;
+constexpr uint8_t CBOR_NEGATIVE = 1;
+constexpr uint8_t CBOR_TEXT = 3;
+constexpr uint8_t CBOR_ARRAY = 4;
+constexpr uint8_t CBOR_MAP = 5;
+
+constexpr char CBOR_FALSE = '\xf4';
+constexpr char CBOR_TRUE = '\xf5';
+constexpr char CBOR_NULL = '\xf6';
+constexpr char CBOR_FLOAT32 = '\xfa';
+constexpr char CBOR_FLOAT64 = '\xfb';
+constexpr char CBOR_BREAK = '\xff';
+// Дополнительное значение 31: элемент неопределённой длины, завершается CBOR_BREAK
+constexpr uint8_t CBOR_INDEFINITE = 31;
+
+// Длина начала текста, не обрывающая многобайтовый символ UTF-8 на конце
+size_t CompleteUtf8Prefix(std::string_view text) {
+    size_t pos = text.size();
+    for (int back = 0; back < 4 && pos > 0; ++back) {
+        --pos;
+        const auto byte = static_cast<unsigned char>(text[pos]);
+        if ((byte & 0xC0) != 0x80) {
+            const size_t length = byte < 0x80 ? 1 : byte >= 0xF0 ? 4 : byte >= 0xE0 ? 3 : byte >= 0xC0 ? 2 : 1;
+            return pos + length <= text.size() ? text.size() : pos;
+        }
+    }
+    return text.size();
+}
+
+}  // namespace
+
+OutputFormat ParseOutputFormat(std::string_view name) {
+    if (name == "json"sv) {
+        return OutputFormat::PRETTY;
+    }
+    if (name == "compact"sv) {
+        return OutputFormat::COMPACT;
+    }
+    if (name == "cbor"sv) {
+        return OutputFormat::CBOR;
+    }
+    throw std::invalid_argument("Unknown output format: "s + std::string(name));
+}
+
+/*
+ * Буфер потока для StringValue(): записанный текст уходит в писатель фрагментами
+ * (экранированными для JSON, отдельными строками CBOR). Фрагмент не обрывает символ UTF-8,
+ * как того требует RFC 8949 для частей строки неопределённой длины
+ */
+class Writer::StringValueBuffer final : public std::streambuf {
+public:
+    explicit StringValueBuffer(Writer& writer)
+        : writer_(writer) {
+        setp(chars_, chars_ + sizeof(chars_));
+    }
+
+    // Передаёт писателю остаток текста
+    void Finish() {
+        writer_.PutStringChunk({ pbase(), static_cast<size_t>(pptr() - pbase()) });
+        setp(chars_, chars_ + sizeof(chars_));
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        Drain();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char* str, std::streamsize count) override {
+        std::streamsize left = count;
+        while (left > 0) {
+            if (pptr() == epptr()) {
+                Drain();
+            }
+            const std::streamsize part = std::min<std::streamsize>(left, epptr() - pptr());
+            std::copy(str, str + part, pptr());
+            pbump(static_cast<int>(part));
+            str += part;
+            left -= part;
+        }
+        return count;
+    }
+
+    int sync() override {
+        Drain();
+        return 0;
+    }
+
+private:
+    // Передаёт писателю накопленный текст; неполный символ UTF-8 на конце остаётся в буфере
+    void Drain() {
+        const std::string_view text(pbase(), static_cast<size_t>(pptr() - pbase()));
+        const size_t complete = CompleteUtf8Prefix(text);
+        writer_.PutStringChunk(text.substr(0, complete));
+        const size_t tail = text.size() - complete;
+        std::copy(text.end() - tail, text.end(), chars_);
+        setp(chars_, chars_ + sizeof(chars_));
+        pbump(static_cast<int>(tail));
+    }
+
+    Writer& writer_;
+    char chars_[4096];
+};
+
+Writer::Writer(std::ostream& output, OutputFormat format)
+    : output_(output)
+    , format_(format) {
+    buffer_.reserve(FLUSH_THRESHOLD + 1024);
+}
+
+Writer::~Writer() {
+    Flush();
+}
+
+Writer::DictValueContext Writer::Key(std::string_view key) {
+    if (stack_.empty() || !stack_.back().is_dict || key_pending_) {
+        throw std::logic_error("Key() outside a dict"s);
+    }
+    Frame& frame = stack_.back();
+    if (format_ == OutputFormat::PRETTY) {
+        PutRaw(frame.empty ? "\n"sv : ",\n"sv);
+        PutIndent(stack_.size());
+    } else if (format_ == OutputFormat::COMPACT && !frame.empty) {
+        PutRaw(","sv);
+    }
+    frame.empty = false;
+    PutString(key);
+    if (format_ != OutputFormat::CBOR) {
+        PutRaw(format_ == OutputFormat::PRETTY ? ": "sv : ":"sv);
+    }
+    key_pending_ = true;
+    return BaseContext{*this};
+}
+
+Writer::BaseContext Writer::Value(std::nullptr_t) {
+    BeginValue();
+    if (format_ == OutputFormat::CBOR) {
+        buffer_.push_back(CBOR_NULL);
+    } else {
+        PutRaw("null"sv);
+    }
+    EndValue();
+    return *this;
+}
+
+Writer::BaseContext Writer::Value(bool value) {
+    BeginValue();
+    if (format_ == OutputFormat::CBOR) {
+        buffer_.push_back(value ? CBOR_TRUE : CBOR_FALSE);
+    } else {
+        PutRaw(value ? "true"sv : "false"sv);
+    }
+    EndValue();
+    return *this;
+}
+
+Writer::BaseContext Writer::Value(int value) {
+    BeginValue();
+    if (format_ == OutputFormat::CBOR) {
+        //--отрицательное n кодируется как -1 - n
+        if (value >= 0) {
+            PutCborHead(CBOR_UNSIGNED, static_cast<uint64_t>(value));
+        } else {
+            PutCborHead(CBOR_NEGATIVE, static_cast<uint64_t>(-1 - static_cast<int64_t>(value)));
+        }
+        EndValue();
+        return *this;
+    }
+    char chars[16];
+    const auto [end, ec] = std::to_chars(std::begin(chars), std::end(chars), value);
+    PutRaw({ chars, static_cast<size_t>(end - chars) });
+    EndValue();
+    return *this;
+}
+
+Writer::BaseContext Writer::Value(double value) {
+    BeginValue();
+    if (format_ == OutputFormat::CBOR) {
+        //--значения, точно представимые во float, занимают 5 байт вместо 9
+        if (const float narrow = static_cast<float>(value); static_cast<double>(narrow) == value) {
+            uint32_t bits;
+            std::memcpy(&bits, &narrow, sizeof(bits));
+            buffer_.push_back(CBOR_FLOAT32);
+            PutBigEndian(bits, sizeof(bits));
+        } else {
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            buffer_.push_back(CBOR_FLOAT64);
+            PutBigEndian(bits, sizeof(bits));
+        }
+        EndValue();
+        return *this;
+    }
+    char chars[32];
+    const auto [end, ec] = std::to_chars(std::begin(chars), std::end(chars), value);
+    PutRaw({ chars, static_cast<size_t>(end - chars) });
+    EndValue();
+    return *this;
+}
+
+Writer::BaseContext Writer::Value(std::string_view value) {
+    BeginValue();
+    PutString(value);
+    EndValue();
+    return *this;
+}
+
+Writer::BaseContext Writer::Value(const char* value) {
+    return Value(std::string_view{ value });
+}
+
+Writer::BaseContext Writer::Value(const std::string& value) {
+    return Value(std::string_view{ value });
+}
+
+Writer::BaseContext Writer::Value(const Node& value) {
+    std::visit([this](const auto& item) {
+        using T = std::decay_t<decltype(item)>;
+        if constexpr (std::is_same_v<T, Array>) {
+            StartArray();
+            for (const Node& node : item) {
+                Value(node);
+            }
+            EndArray();
+        } else if constexpr (std::is_same_v<T, Dict>) {
+            StartDict();
+            for (const auto& [key, node] : item) {
+                Key(key);
+                Value(node);
+            }
+            EndDict();
+        } else {
+            Value(item);
+        }
+    }, value.GetValue());
+    return *this;
+}
+
+Writer::BaseContext Writer::StringValue(const std::function<void(std::ostream&)>& render) {
+    BeginValue();
+    if (format_ == OutputFormat::CBOR) {
+        PutCborIndefinite(CBOR_TEXT);
+    } else {
+        buffer_.push_back('"');
+    }
+    {
+        StringValueBuffer chunks(*this);
+        std::ostream out(&chunks);
+        render(out);
+        chunks.Finish();
+    }
+    buffer_.push_back(format_ == OutputFormat::CBOR ? CBOR_BREAK : '"');
+    EndValue();
+    return *this;
+}
+
+Writer::DictItemContext Writer::StartDict() {
+    BeginValue();
+    if (format_ == OutputFormat::CBOR) {
+        PutCborIndefinite(CBOR_MAP);
+    } else {
+        PutRaw("{"sv);
+    }
+    stack_.push_back({ true, true });
+    return BaseContext{*this};
+}
+
+Writer::ArrayItemContext Writer::StartArray() {
+    BeginValue();
+    if (format_ == OutputFormat::CBOR) {
+        PutCborIndefinite(CBOR_ARRAY);
+    } else {
+        PutRaw("["sv);
+    }
+    stack_.push_back({ false, true });
+    return BaseContext{*this};
+}
+
+Writer::BaseContext Writer::EndDict() {
+    if (stack_.empty() || !stack_.back().is_dict || key_pending_) {
+        throw std::logic_error("EndDict() outside a dict"s);
+    }
+    EndContainer(true);
+    return *this;
+}
+
+Writer::BaseContext Writer::EndArray() {
+    if (stack_.empty() || stack_.back().is_dict) {
+        throw std::logic_error("EndArray() outside an array"s);
+    }
+    EndContainer(false);
+    return *this;
+}
+
+void Writer::Flush() {
+    output_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+}
+
+void Writer::BeginValue() {
+    if (finished_) {
+        throw std::logic_error("Attempt to change finalized JSON"s);
+    }
+    if (stack_.empty()) {
+        return;
+    }
+    Frame& frame = stack_.back();
+    if (frame.is_dict) {
+        if (!key_pending_) {
+            throw std::logic_error("New object in wrong context"s);
+        }
+        key_pending_ = false;
+        return;
+    }
+    if (format_ == OutputFormat::PRETTY) {
+        PutRaw(frame.empty ? "\n"sv : ",\n"sv);
+        PutIndent(stack_.size());
+    } else if (format_ == OutputFormat::COMPACT && !frame.empty) {
+        PutRaw(","sv);
+    }
+    frame.empty = false;
+}
+
+void Writer::EndValue() {
+    if (stack_.empty()) {
+        finished_ = true;
+    }
+    FlushIfFull();
+}
+
+void Writer::EndContainer(bool is_dict) {
+    const bool empty = stack_.back().empty;
+    stack_.pop_back();
+    if (format_ == OutputFormat::CBOR) {
+        buffer_.push_back(CBOR_BREAK);
+    } else {
+        if (format_ == OutputFormat::PRETTY) {
+            //--формат json::Print: пустой контейнер тоже занимает две строки
+            PutRaw(empty ? "\n\n"sv : "\n"sv);
+            PutIndent(stack_.size());
+        }
+        PutRaw(is_dict ? "}"sv : "]"sv);
+    }
+    EndValue();
+}
+
+void Writer::PutIndent(size_t depth) {
+    buffer_.append(depth * INDENT_STEP, ' ');
+}
+
+void Writer::PutString(std::string_view value) {
+    if (format_ == OutputFormat::CBOR) {
+        PutCborHead(CBOR_TEXT, value.size());
+        PutRaw(value);
+        FlushIfFull();
+        return;
+    }
+    buffer_.push_back('"');
+    PutEscaped(value);
+    buffer_.push_back('"');
+}
+
+void Writer::PutStringChunk(std::string_view chunk) {
+    if (format_ != OutputFormat::CBOR) {
+        PutEscaped(chunk);
+    } else if (!chunk.empty()) {
+        PutString(chunk);
+    }
+}
+
+// Экранирование как в json::Print: отрезки без спецсимволов ищутся по 8 байт (swar.h)
+// и копируются целиком
+void Writer::PutEscaped(std::string_view text) {
+    const char* pos = text.data();
+    const char* const end = pos + text.size();
+    while (pos != end) {
+        const size_t plain = swar::FindStringSpecial(pos, end);
+        buffer_.append(pos, plain);
+        pos += plain;
+        if (pos == end) {
+            break;
+        }
+        switch (const char c = *pos++) {
+            case '\r':
+                buffer_.append("\\r"sv);
+                break;
+            case '\n':
+                buffer_.append("\\n"sv);
+                break;
+            case '\t':
+                buffer_.append("\\t"sv);
+                break;
+            case '"':
+                buffer_.append("\\\""sv);
+                break;
+            case '\\':
+                buffer_.append("\\\\"sv);
+                break;
+            default:
+                //--прочие управляющие символы выводятся как есть
+                buffer_.push_back(c);
+                break;
+        }
+    }
+    FlushIfFull();
+}
+
+void Writer::PutRaw(std::string_view text) {
+    buffer_.append(text);
+}
+
+void Writer::PutCborHead(uint8_t major_type, uint64_t argument) {
+    const auto head = static_cast<uint8_t>(major_type << 5);
+    if (argument < 24) {
+        buffer_.push_back(static_cast<char>(head | argument));
+    } else if (argument <= 0xFF) {
+        buffer_.push_back(static_cast<char>(head | 24));
+        PutBigEndian(argument, 1);
+    } else if (argument <= 0xFFFF) {
+        buffer_.push_back(static_cast<char>(head | 25));
+        PutBigEndian(argument, 2);
+    } else if (argument <= 0xFFFFFFFF) {
+        buffer_.push_back(static_cast<char>(head | 26));
+        PutBigEndian(argument, 4);
+    } else {
+        buffer_.push_back(static_cast<char>(head | 27));
+        PutBigEndian(argument, 8);
+    }
+}
+
+void Writer::PutCborIndefinite(uint8_t major_type) {
+    buffer_.push_back(static_cast<char>((major_type << 5) | CBOR_INDEFINITE));
+}
+
+void Writer::PutBigEndian(uint64_t value, size_t size) {
+    for (size_t shift = size * 8; shift > 0; shift -= 8) {
+        buffer_.push_back(static_cast<char>((value >> (shift - 8)) & 0xFF));
+    }
+}
+
+void Writer::FlushIfFull() {
+    if (buffer_.size() >= FLUSH_THRESHOLD) {
+        Flush();
+    }
+}
+
+}  // namespace json
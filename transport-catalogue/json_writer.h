@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "json.h"
+
+namespace json {
+
+// Формат ответов: JSON как у json::Print, JSON без отступов и переводов строк, бинарный CBOR (RFC 8949)
+enum class OutputFormat {
+    PRETTY,
+    COMPACT,
+    CBOR
+};
+
+// "json", "compact" или "cbor"; std::invalid_argument для прочих названий
+OutputFormat ParseOutputFormat(std::string_view name);
+
+/**
+ * Потоковая запись ответов без построения дерева Node. В формате PRETTY вывод совпадает с json::Print.
+ * В CBOR словари, массивы и StringValue() пишутся с неопределённой длиной, поэтому запись
+ * не требует знать число элементов заранее.
+ * Данные копятся в буфере и сбрасываются в поток крупными блоками (и в деструкторе).
+ * Цепочки вызовов проверяются на этапе компиляции так же, как в json::Builder.
+ * Ключи словаря выводятся в порядке вызовов Key(): чтобы вывод совпадал с json::Print,
+ * их нужно передавать в лексикографическом порядке
+ */
+class Writer {
+private:
+    class BaseContext;
+    class DictValueContext;
+    class DictItemContext;
+    class ArrayItemContext;
+
+public:
+    explicit Writer(std::ostream& output, OutputFormat format = OutputFormat::PRETTY);
+    ~Writer();
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    DictValueContext Key(std::string_view key);
+    BaseContext Value(std::nullptr_t);
+    BaseContext Value(bool value);
+    BaseContext Value(int value);
+    BaseContext Value(double value);
+    BaseContext Value(std::string_view value);
+    BaseContext Value(const char* value);
+    BaseContext Value(const std::string& value);
+    BaseContext Value(const Node& value);
+    // Строковое значение, текст которого пишет render: поток экранирует его прямо в буфер писателя
+    BaseContext StringValue(const std::function<void(std::ostream&)>& render);
+    DictItemContext StartDict();
+    ArrayItemContext StartArray();
+    BaseContext EndDict();
+    BaseContext EndArray();
+
+    // Передаёт накопленный текст в поток
+    void Flush();
+
+private:
+    static constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+    static constexpr int INDENT_STEP = 4;
+
+    class StringValueBuffer;
+
+    struct Frame {
+        bool is_dict = false;
+        bool empty = true;
+    };
+
+    // Отступ и разделитель перед очередным значением; проверяет, что значение здесь допустимо
+    void BeginValue();
+    void EndValue();
+    void EndContainer(bool is_dict);
+
+    void PutIndent(size_t depth);
+    void PutString(std::string_view value);
+    // Очередной фрагмент строки из StringValue()
+    void PutStringChunk(std::string_view chunk);
+    void PutEscaped(std::string_view text);
+    void PutRaw(std::string_view text);
+    // Заголовок элемента CBOR: старший тип и число (значение, длина)
+    void PutCborHead(uint8_t major_type, uint64_t argument);
+    // Заголовок словаря, массива или строки неопределённой длины
+    void PutCborIndefinite(uint8_t major_type);
+    // Младшие size байт value, старший первым
+    void PutBigEndian(uint64_t value, size_t size);
+    void FlushIfFull();
+
+    std::ostream& output_;
+    const OutputFormat format_;
+    std::string buffer_;
+    std::vector<Frame> stack_;
+    bool key_pending_ = false;
+    bool finished_ = false;
+
+    // Key() → Value(), StartDict(), StartArray()
+    // StartDict() → Key(), EndDict()
+    // Key() → Value() → Key(), EndDict()
+    // StartArray() → Value(), StartDict(), StartArray(), EndArray()
+    // StartArray() → Value() → Value(), StartDict(), StartArray(), EndArray()
+
+    class BaseContext {
+    public:
+        BaseContext(Writer& writer) : writer_(writer) {}
+        DictValueContext Key(std::string_view key) {
+            return writer_.Key(key);
+        }
+        template <typename T>
+        BaseContext Value(T&& value) {
+            return writer_.Value(std::forward<T>(value));
+        }
+        BaseContext StringValue(const std::function<void(std::ostream&)>& render) {
+            return writer_.StringValue(render);
+        }
+        DictItemContext StartDict() {
+            return writer_.StartDict();
+        }
+        ArrayItemContext StartArray() {
+            return writer_.StartArray();
+        }
+        BaseContext EndDict() {
+            return writer_.EndDict();
+        }
+        BaseContext EndArray() {
+            return writer_.EndArray();
+        }
+    private:
+        Writer& writer_;
+    };
+
+    class DictValueContext : public BaseContext {
+    public:
+        DictValueContext(BaseContext base) : BaseContext(base) {}
+        template <typename T>
+        DictItemContext Value(T&& value) { return BaseContext::Value(std::forward<T>(value)); }
+        DictItemContext StringValue(const std::function<void(std::ostream&)>& render) { return BaseContext::StringValue(render); }
+        DictValueContext Key(std::string_view key) = delete;
+        BaseContext EndDict() = delete;
+        BaseContext EndArray() = delete;
+    };
+
+    class DictItemContext : public BaseContext {
+    public:
+        DictItemContext(BaseContext base) : BaseContext(base) {}
+        template <typename T>
+        BaseContext Value(T&& value) = delete;
+        BaseContext StringValue(const std::function<void(std::ostream&)>& render) = delete;
+        BaseContext EndArray() = delete;
+        DictItemContext StartDict() = delete;
+        ArrayItemContext StartArray() = delete;
+    };
+
+    class ArrayItemContext : public BaseContext {
+    public:
+        ArrayItemContext(BaseContext base) : BaseContext(base) {}
+        template <typename T>
+        ArrayItemContext Value(T&& value) { return BaseContext::Value(std::forward<T>(value)); }
+        ArrayItemContext StringValue(const std::function<void(std::ostream&)>& render) { return BaseContext::StringValue(render); }
+        DictValueContext Key(std::string_view key) = delete;
+        BaseContext EndDict() = delete;
+    };
+};
+
+}  // namespace json
@@ -1,35 +1,123 @@
 #include <iostream>
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <string_view>
+#include <vector>
 
 #include "transport_catalogue.h"
 #include "transport_router.h"
 #include "request_handler.h"
 #include "json_reader.h"
 #include "map_renderer.h"
+#include "catalogue_snapshot.h"
+#include "catalogue_journal.h"
+#include "mapped_file.h"
 
 using namespace std;
 using namespace model;
 using namespace io;
 
-std::stringstream ReadFile(const std::string& file_name) {
-    std::ifstream f(file_name);
-    if (!f.is_open()) {
-        throw std::runtime_error("Error: can not open file: "s + file_name);
+// Читает документ запросов из стандартного ввода или, если задан файл, разбирает его
+// прямо по отображению в память без копирования в буферы процесса
+JsonReader ReadRequests(const std::string& input_name) {
+    if (input_name.empty()) {
+        return JsonReader(std::cin);
     }
-    std::stringstream ss;
-    ss << f.rdbuf();
-    return ss;
+    const io::MappedFile input(input_name, io::MappedFile::Advice::SEQUENTIAL);
+    return JsonReader(input.View());
 }
 
-int main() {
+// Загружает справочник из снимка и дописывает изменения из журнала
+std::unique_ptr<TransportCatalogue> LoadCatalogue(const serialization::SerializationSettings& settings) {
+    auto catalogue = std::make_unique<TransportCatalogue>();
+    serialization::RestoreCatalogue(std::make_shared<const serialization::CatalogueSnapshot>(settings.file), *catalogue);
+    if (!settings.journal.empty()) {
+        serialization::ReplayJournal(settings.journal, *catalogue);
+    }
+    return catalogue;
+}
+
+// Перечитывает снимок и журнал, публикует новую версию справочника и освобождает вытесненные версии,
+// которые уже никто не читает. Возвращает номер опубликованной версии
+uint64_t ReloadCatalogue(handler::VersionedCatalogue& versions, const JsonReader& reader) {
+    const uint64_t number = versions.Publish(reader.MakeCatalogueVersion(LoadCatalogue(reader.ParseSerializationSettings())));
+    versions.CollectRetired();
+    return number;
+}
+
+void PrintUsage(std::ostream& stream = std::cerr) {
+    stream << "Usage: transport_catalogue [make_base|update_base|process_requests] [--input=<file>] [--output=json|compact|cbor]\n"sv;
+}
+
+int main(int argc, char* argv[]) {
 
-    TransportCatalogue catalogue;
+    handler::VersionedCatalogue versions;
 
-    JsonReader reader(std::cin);
-    reader.ApplyBaseRequests(catalogue);
-    reader.ApplyStatRequests(catalogue);
+    //--файл запросов вместо стандартного ввода и формат ответов на весь запуск
+    //--(output_format в документе запросов важнее)
+    constexpr std::string_view input_option = "--input="sv;
+    constexpr std::string_view output_option = "--output="sv;
+    std::string input_name;
+    json::OutputFormat output_format = json::OutputFormat::PRETTY;
+    std::vector<std::string_view> args;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg(argv[i]);
+        if (arg.substr(0, input_option.size()) == input_option) {
+            input_name = std::string(arg.substr(input_option.size()));
+        } else if (arg.substr(0, output_option.size()) == output_option) {
+            output_format = json::ParseOutputFormat(arg.substr(output_option.size()));
+        } else {
+            args.push_back(arg);
+        }
+    }
+
+    if (args.empty()) {
+        JsonReader reader = ReadRequests(input_name);
+        reader.SetDefaultOutputFormat(output_format);
+        versions.Publish(reader.MakeCatalogueVersion());
+        reader.ApplyStatRequests(*versions.Acquire());
+        return 0;
+    }
+    if (args.size() != 1) {
+        PrintUsage();
+        return 1;
+    }
+
+    const std::string_view mode = args.front();
+    if (mode == "make_base"sv) {
+        //--base_requests и serialization_settings: справочник сохраняется в бинарный снимок
+        JsonReader reader = ReadRequests(input_name);
+        TransportCatalogue catalogue;
+        reader.ApplyBaseRequests(catalogue);
+        const auto& settings = reader.ParseSerializationSettings();
+        serialization::ReplaceSnapshot(catalogue, settings.file);
+        if (!settings.journal.empty()) {
+            serialization::CatalogueJournal(settings.journal).Reset();
+        }
+    } else if (mode == "update_base"sv) {
+        //--base_requests дописываются к снимку через журнал изменений
+        JsonReader reader = ReadRequests(input_name);
+        const auto& settings = reader.ParseSerializationSettings();
+        if (settings.journal.empty()) {
+            throw std::runtime_error("update_base: serialization_settings.journal is not set"s);
+        }
+        auto catalogue = LoadCatalogue(settings);
+        serialization::CatalogueJournal journal(settings.journal);
+        catalogue->SetChangeListener(&journal);
+        reader.ApplyBaseRequests(*catalogue);
+        catalogue->SetChangeListener(nullptr);
+        if (settings.journal_compaction_threshold > 0 && journal.GetRecordCount() >= settings.journal_compaction_threshold) {
+            serialization::CompactJournal(*catalogue, settings.file, journal);
+        }
+    } else if (mode == "process_requests"sv) {
+        //--stat_requests и serialization_settings: справочник загружается из снимка и журнала
+        JsonReader reader = ReadRequests(input_name);
+        reader.SetDefaultOutputFormat(output_format);
+        ReloadCatalogue(versions, reader);
+        reader.ApplyStatRequests(*versions.Acquire());
+    } else {
+        PrintUsage();
+        return 1;
+    }
 
     /*auto settings = reader.ParseRenderSettings();
     renderer::MapRenderer map_renderer(catalogue, settings);
@@ -37,4 +125,4 @@ int main() {
     doc.Render(std::cout);*/
 
     return 0;
-}
\ No newline at end of file
+}
@@ -13,15 +13,14 @@ namespace renderer {
         };
     }
 
-    void MapRenderer::GenerateRoutesLine(svg::Document& doc, const std::set<std::string>& bus_names, const std::vector<svg::Color>& color_palette) const {
+    void MapRenderer::GenerateRoutesLine(svg::Document& doc, const std::vector<const model::Bus*>& sorted_buses, const std::vector<svg::Color>& color_palette) const {
         size_t color_idx = 0;
         size_t color_cnt = color_palette.size();
-        for (const auto& bus_name : bus_names) {
+        for (const model::Bus* bus : sorted_buses) {
             svg::Polyline polyline;
-            auto bus = db_.FindBusByName(bus_name);
-            if (bus->route.empty()) continue;
+            if (bus->stops.empty()) continue;
 
-            for (const auto& stop_name : bus->route) {
+            for (std::string_view stop_name : bus->Route()) {
                 auto stop = db_.FindStopByName(stop_name);
                 polyline.AddPoint(proj_(stop->coord));
             }
@@ -37,16 +36,19 @@ namespace renderer {
         
     }
 
-    void MapRenderer::GenerateRoutesLabel(svg::Document& doc, const std::set<std::string>& bus_names, const std::vector<svg::Color>& color_palette) const
+    void MapRenderer::GenerateRoutesLabel(svg::Document& doc, const std::vector<const model::Bus*>& sorted_buses, const std::vector<svg::Color>& color_palette) const
     {
         //--
         size_t color_idx = 0;
         size_t color_cnt = color_palette.size();
-        for (const auto& bus_name : bus_names) {
-            auto bus = db_.FindBusByName(bus_name);
-            if (bus->route.empty()) continue;
+        for (const model::Bus* bus : sorted_buses) {
+            if (bus->stops.empty()) continue;
             //--
-            for (const auto& stop_name : bus->end_points) {
+            //--у кольцевого маршрута и у маршрута с совпадающими концами одна конечная
+            const std::string_view end_points[] = { bus->stops.front(), bus->stops.back() };
+            const size_t end_point_count = bus->is_roundtrip || end_points[0] == end_points[1] ? 1 : 2;
+            for (size_t i = 0; i < end_point_count; ++i) {
+                const std::string_view stop_name = end_points[i];
                 svg::Text text_front, text_back;
                 auto stop = db_.FindStopByName(stop_name);
                 text_front.SetFillColor(color_palette.at(color_idx % color_cnt))
@@ -55,7 +57,7 @@ namespace renderer {
                     .SetFontSize(settings_.bus_label_font_size)
                     .SetFontFamily("Verdana")
                     .SetFontWeight("bold")
-                    .SetData(bus->name);
+                    .SetData(std::string(bus->name));
 
                 text_back.SetFillColor(settings_.underlayer_color)
                     .SetStrokeColor(settings_.underlayer_color)
@@ -67,21 +69,18 @@ namespace renderer {
                     .SetFontSize(settings_.bus_label_font_size)
                     .SetFontFamily("Verdana")
                     .SetFontWeight("bold")
-                    .SetData(bus->name);
+                    .SetData(std::string(bus->name));
 
                 doc.Add(std::move(text_back));
                 doc.Add(std::move(text_front));
-
-                if (bus->end_points.size() == 2 && bus->end_points[0] == bus->end_points[1]) break;
             }
             color_idx++;
         }
     }
 
-    void MapRenderer::GenerateStopsCircle(svg::Document& doc, const std::set<std::string_view>& sorted_stops) const
+    void MapRenderer::GenerateStopsCircle(svg::Document& doc, const std::vector<const model::Stop*>& sorted_stops) const
     {        
-        for (const auto& stop_name : sorted_stops) {
-            auto stop = db_.FindStopByName(stop_name);
+        for (const model::Stop* stop : sorted_stops) {
             svg::Circle circle;
             circle.SetCenter(proj_(stop->coord))
                 .SetRadius(settings_.stop_radius)
@@ -90,17 +89,16 @@ namespace renderer {
         }
     }
 
-    void MapRenderer::GenerateStopsLabel(svg::Document& doc, const std::set<std::string_view>& sorted_stops) const
+    void MapRenderer::GenerateStopsLabel(svg::Document& doc, const std::vector<const model::Stop*>& sorted_stops) const
     {
-        for (const auto& stop_name : sorted_stops) {
+        for (const model::Stop* stop : sorted_stops) {
             svg::Text text_front, text_back;
-            auto stop = db_.FindStopByName(stop_name);
             text_front.SetFillColor("black")
                 .SetPosition(proj_(stop->coord))
                 .SetOffset({ settings_.stop_label_offset.first, settings_.stop_label_offset.second })
                 .SetFontSize(settings_.stop_label_font_size)
                 .SetFontFamily("Verdana")
-                .SetData(stop->name);
+                .SetData(std::string(stop->name));
 
             text_back.SetFillColor(settings_.underlayer_color)
                 .SetStrokeColor(settings_.underlayer_color)
@@ -111,47 +109,50 @@ namespace renderer {
                 .SetOffset({ settings_.stop_label_offset.first, settings_.stop_label_offset.second })
                 .SetFontSize(settings_.stop_label_font_size)
                 .SetFontFamily("Verdana")
-                .SetData(stop->name);
+                .SetData(std::string(stop->name));
 
             doc.Add(std::move(text_back));
             doc.Add(std::move(text_front));
         }
     }    
 
-    svg::Document MapRenderer::RenderMap() const {
-
-        const auto& bus_data = db_.GetBusData();
-        std::set<std::string> bus_names;
-        std::transform(bus_data.begin(), bus_data.end(), std::inserter(bus_names, bus_names.begin()),
-            [](const std::pair<std::string_view, const model::Bus*>& data) {
-                return std::string(data.first);
+    const svg::Document& MapRenderer::RenderMap() const {
+        std::call_once(map_once_, [this]() {
+            map_ = BuildMap();
             });
+        return map_;
+    }
+
+    svg::Document MapRenderer::BuildMap() const {
+
+        const std::vector<const model::Bus*> sorted_buses = db_.GetSortedBuses();
 
         std::vector<svg::Color> color_palette = settings_.color_palette;
 
         svg::Document doc;
         //--
-        GenerateRoutesLine(doc, bus_names, color_palette);
-        GenerateRoutesLabel(doc, bus_names, color_palette);
+        GenerateRoutesLine(doc, sorted_buses, color_palette);
+        GenerateRoutesLabel(doc, sorted_buses, color_palette);
         //--
-        std::set<std::string_view> sorted_stops = GetSortedStops();
+        const std::vector<const model::Stop*> sorted_stops = db_.GetSortedStopsInRoutes();
         GenerateStopsCircle(doc, sorted_stops);
         GenerateStopsLabel(doc, sorted_stops);
 
         return doc;
     }
 
-    std::set<std::string_view> MapRenderer::GetSortedStops() const {
-        using namespace model;
-        return db_.GetSortedStopsInRoutes();
+    model::MemoryReport MapRenderer::GetMemoryReport() const {
+        model::MemoryReport report;
+        report.Add("geo_coords", geo_coords_.size(), model::VectorBytes(geo_coords_));
+        const svg::Document& doc = RenderMap();
+        report.Add("map_document", doc.GetObjectCount(), doc.GetMemoryUsage());
+        return report;
     }
 
     std::vector<geo::Coordinates> MapRenderer::GetGeoCoords() const {
         using namespace model;
         std::vector<geo::Coordinates> geo_coords;
-        const auto& stops_in_buses = db_.GetSortedStopsInRoutes();
-        for (const auto& stop_name : stops_in_buses) {
-            auto stop = db_.FindStopByName(stop_name);
+        for (const Stop* stop : db_.GetSortedStopsInRoutes()) {
             geo_coords.emplace_back(stop->coord);
         }
         return geo_coords;
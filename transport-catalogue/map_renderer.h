@@ -13,6 +13,7 @@
 #include <vector>
 #include <set>
 #include <iterator>
+#include <mutex>
 /*
  * В этом файле вы можете разместить код, отвечающий за визуализацию карты маршрутов в формате SVG.
  */
@@ -120,20 +121,28 @@ namespace renderer {
             proj_(std::move(SphereProjector{ geo_coords_.begin(), geo_coords_.end(), settings_.width, settings_.height, settings_.padding })) {           
         }
 
-        svg::Document RenderMap() const;
+        // Документ карты строится при первом обращении и затем переиспользуется:
+        // справочник не меняется, пока жив визуализатор
+        const svg::Document& RenderMap() const;
+
+        // Память визуализатора, включая документ карты, который выдаётся запросу Map
+        model::MemoryReport GetMemoryReport() const;
 
     private:
-        std::set<std::string_view> GetSortedStops() const;
+        svg::Document BuildMap() const;
         std::vector<geo::Coordinates> GetGeoCoords() const;
-        void GenerateRoutesLine(svg::Document& doc, const std::set<std::string>& bus_names, const std::vector<svg::Color>& color_palette) const;
-        void GenerateRoutesLabel(svg::Document& doc, const std::set<std::string>& bus_names, const std::vector<svg::Color>& color_palette) const;
-        void GenerateStopsCircle(svg::Document& doc, const std::set<std::string_view>& sorted_stops) const;
-        void GenerateStopsLabel(svg::Document& doc, const std::set<std::string_view>& sorted_stops) const;
+        void GenerateRoutesLine(svg::Document& doc, const std::vector<const model::Bus*>& sorted_buses, const std::vector<svg::Color>& color_palette) const;
+        void GenerateRoutesLabel(svg::Document& doc, const std::vector<const model::Bus*>& sorted_buses, const std::vector<svg::Color>& color_palette) const;
+        void GenerateStopsCircle(svg::Document& doc, const std::vector<const model::Stop*>& sorted_stops) const;
+        void GenerateStopsLabel(svg::Document& doc, const std::vector<const model::Stop*>& sorted_stops) const;
 
         const model::TransportCatalogue& db_;
         const RenderSettings& settings_;
         std::vector<geo::Coordinates> geo_coords_;
         SphereProjector proj_;
+        //--визуализатор версии справочника читают несколько потоков
+        mutable std::once_flag map_once_;
+        mutable svg::Document map_;
 	};
 
 }
@@ -0,0 +1,113 @@
+#include "mapped_file.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TC_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std::literals;
+
+namespace io {
+
+#ifdef TC_HAS_MMAP
+    MappedFile::MappedFile(const std::string& file_name, Advice advice) {
+        int fd = ::open(file_name.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Error: can not open file: "s + file_name);
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Error: can not stat file: "s + file_name);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Error: can not map file: "s + file_name);
+            }
+            data_ = static_cast<const char*>(addr);
+            mapped_ = true;
+            if (advice == Advice::SEQUENTIAL) {
+                //--подсказки необязательны: ошибки madvise не мешают чтению
+                ::madvise(addr, size_, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+                ::madvise(addr, size_, MADV_HUGEPAGE);
+#endif
+            }
+        }
+        ::close(fd);
+    }
+#else
+    MappedFile::MappedFile(const std::string& file_name, Advice) {
+        std::ifstream f(file_name, std::ios::binary | std::ios::ate);
+        if (!f.is_open()) {
+            throw std::runtime_error("Error: can not open file: "s + file_name);
+        }
+        buffer_.resize(static_cast<size_t>(f.tellg()));
+        f.seekg(0);
+        f.read(buffer_.data(), buffer_.size());
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+    }
+#endif
+
+    MappedFile::~MappedFile() {
+        Release();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+        , mapped_(std::exchange(other.mapped_, false))
+        , buffer_(std::move(other.buffer_)) {
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            Release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            mapped_ = std::exchange(other.mapped_, false);
+            buffer_ = std::move(other.buffer_);
+        }
+        return *this;
+    }
+
+    void MappedFile::Release() {
+#ifdef TC_HAS_MMAP
+        if (mapped_) {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+#endif
+        data_ = nullptr;
+        size_ = 0;
+        mapped_ = false;
+        buffer_.clear();
+    }
+
+    void SyncToDisk(const std::string& path) {
+#ifdef TC_HAS_MMAP
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Error: can not open for sync: "s + path);
+        }
+        const bool synced = ::fsync(fd) == 0;
+        ::close(fd);
+        if (!synced) {
+            throw std::runtime_error("Error: can not sync to disk: "s + path);
+        }
+#else
+        (void)path;
+#endif
+    }
+
+}
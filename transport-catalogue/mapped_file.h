@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace io {
+
+    /**
+     * Файл, отображённый в память только для чтения.
+     * На POSIX-системах используется mmap, на остальных файл целиком читается в буфер.
+     */
+    class MappedFile {
+    public:
+        // Подсказка ядру о порядке чтения отображения
+        enum class Advice {
+            NORMAL,
+            // Файл читается один раз от начала к концу: агрессивное упреждающее чтение и крупные страницы
+            SEQUENTIAL
+        };
+
+        explicit MappedFile(const std::string& file_name, Advice advice = Advice::NORMAL);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        const char* Data() const {
+            return data_;
+        }
+        size_t Size() const {
+            return size_;
+        }
+        std::string_view View() const {
+            return { data_, size_ };
+        }
+
+    private:
+        void Release();
+
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+        bool mapped_ = false;
+        std::vector<char> buffer_;
+    };
+
+    // Сбрасывает содержимое файла или каталога (запись о переименовании) на диск.
+    // При ошибке бросает std::runtime_error; без POSIX ничего не делает
+    void SyncToDisk(const std::string& path);
+
+}
@@ -0,0 +1,37 @@
+#include "memory_report.h"
+
+#include <numeric>
+
+namespace model {
+
+    void MemoryReport::Add(std::string structure, size_t elements, size_t bytes) {
+        structures.push_back({ std::move(structure), elements, bytes });
+    }
+
+    size_t MemoryReport::TotalBytes() const {
+        return std::accumulate(structures.begin(), structures.end(), size_t{ 0 }, [](size_t total, const MemoryUsage& usage) {
+            return total + usage.bytes;
+            });
+    }
+
+    size_t StringHeapBytes(const std::string& str) {
+        static const size_t inline_capacity = std::string().capacity();
+        return str.capacity() > inline_capacity ? str.capacity() + 1 : 0;
+    }
+
+    void* CountingResource::do_allocate(size_t bytes, size_t alignment) {
+        void* ptr = upstream_->allocate(bytes, alignment);
+        allocated_bytes_ += bytes;
+        return ptr;
+    }
+
+    void CountingResource::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+        upstream_->deallocate(ptr, bytes, alignment);
+        allocated_bytes_ -= bytes;
+    }
+
+    bool CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+        return this == &other;
+    }
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace model {
+
+    // Память, занимаемая одной структурой данных
+    struct MemoryUsage {
+        std::string structure;
+        size_t elements = 0;
+        size_t bytes = 0;
+    };
+
+    /**
+     * Отчёт о памяти подсистемы (справочника, маршрутизатора, визуализатора).
+     * bytes структур — оценка по размерам элементов и ёмкостям контейнеров,
+     * arena_bytes — сколько арена подсистемы фактически запросила у системы.
+     */
+    struct MemoryReport {
+        std::vector<MemoryUsage> structures;
+        size_t arena_bytes = 0;
+
+        void Add(std::string structure, size_t elements, size_t bytes);
+        size_t TotalBytes() const;
+    };
+
+    //--оценки для стандартных контейнеров (libstdc++): узел хеш-таблицы хранит указатель на следующий узел
+    //--и кешированный хеш, узел дерева — цвет и три указателя
+
+    template <typename Vector>
+    size_t VectorBytes(const Vector& vec) {
+        return vec.capacity() * sizeof(typename Vector::value_type);
+    }
+
+    template <typename HashTable>
+    size_t HashTableBytes(const HashTable& table) {
+        return table.bucket_count() * sizeof(void*)
+            + table.size() * (2 * sizeof(void*) + sizeof(typename HashTable::value_type));
+    }
+
+    template <typename Tree>
+    size_t TreeBytes(const Tree& tree) {
+        return tree.size() * (4 * sizeof(void*) + sizeof(typename Tree::value_type));
+    }
+
+    // Байты строки в куче (0 для строк, уместившихся во внутренний буфер)
+    size_t StringHeapBytes(const std::string& str);
+
+    /**
+     * Прослойка над upstream, которая считает выделенные через неё байты.
+     * Не потокобезопасна, как и monotonic_buffer_resource, которому служит источником блоков
+     */
+    class CountingResource final : public std::pmr::memory_resource {
+    public:
+        explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+            : upstream_(upstream) {
+        }
+
+        // Байты, выделенные и ещё не возвращённые
+        size_t GetAllocatedBytes() const {
+            return allocated_bytes_;
+        }
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+        std::pmr::memory_resource* upstream_;
+        size_t allocated_bytes_ = 0;
+    };
+
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace model {
+
+    /**
+     * Минимальная совершенная хеш-функция над неизменным набором строк (схема hash-and-displace, CHD).
+     * Ключи раскладываются по корзинам; для каждой корзины подбирается зерно, при котором все её ключи
+     * попадают в свободные ячейки таблицы из ровно n ячеек.
+     * Поиск: одно вычисление хеша строки, одно обращение к таблице и одно сравнение строк.
+     */
+    template <typename Value>
+    class PerfectHashIndex {
+    public:
+        PerfectHashIndex() = default;
+
+        // Строит индекс по диапазону пар (ключ, значение). Ключи должны быть уникальны
+        template <typename InputIt>
+        void Build(InputIt first, InputIt last);
+
+        // Плотный номер ключа в диапазоне [0, Size())
+        std::optional<size_t> FindId(std::string_view key) const {
+            if (keys_.empty()) {
+                return std::nullopt;
+            }
+            const uint64_t hash = Hash(key, salt_);
+            const size_t id = Slot(hash, seeds_[hash % seeds_.size()]);
+            if (keys_[id] != key) {
+                return std::nullopt;
+            }
+            return id;
+        }
+
+        // Значение по ключу либо Value{}, если ключа нет
+        Value Find(std::string_view key) const {
+            auto id = FindId(key);
+            return id ? values_[*id] : Value{};
+        }
+
+        std::string_view GetKey(size_t id) const {
+            return keys_[id];
+        }
+        const Value& GetValue(size_t id) const {
+            return values_[id];
+        }
+        size_t Size() const {
+            return keys_.size();
+        }
+        bool Empty() const {
+            return keys_.empty();
+        }
+        // Байты, занимаемые таблицами индекса (сами строки ключей не учитываются)
+        size_t GetMemoryUsage() const {
+            return seeds_.capacity() * sizeof(uint32_t) + keys_.capacity() * sizeof(std::string_view)
+                + values_.capacity() * sizeof(Value);
+        }
+        void Clear() {
+            seeds_.clear();
+            keys_.clear();
+            values_.clear();
+        }
+
+    private:
+        // Среднее число ключей в корзине
+        static constexpr size_t BUCKET_LOAD = 4;
+        static constexpr uint32_t MAX_SEED = 1u << 20;
+        static constexpr int MAX_ATTEMPTS = 16;
+
+        static uint64_t Mix(uint64_t x) {
+            x ^= x >> 33;
+            x *= 0xff51afd7ed558ccdull;
+            x ^= x >> 33;
+            x *= 0xc4ceb9fe1a85ec53ull;
+            x ^= x >> 33;
+            return x;
+        }
+
+        // FNV-1a, начатый с зерна: соль меняет весь ход хеширования, а не только результат
+        static uint64_t Hash(std::string_view key, uint64_t salt) {
+            uint64_t hash = 0xcbf29ce484222325ull ^ salt;
+            for (char c : key) {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 0x100000001b3ull;
+            }
+            return Mix(hash);
+        }
+
+        size_t Slot(uint64_t hash, uint32_t seed) const {
+            return Mix(hash + 0x9e3779b97f4a7c15ull * seed) % keys_.size();
+        }
+
+        bool TryBuild(const std::vector<std::pair<std::string_view, Value>>& items);
+
+        uint64_t salt_ = 0;
+        std::vector<uint32_t> seeds_;
+        std::vector<std::string_view> keys_;
+        std::vector<Value> values_;
+    };
+
+    template <typename Value>
+    template <typename InputIt>
+    void PerfectHashIndex<Value>::Build(InputIt first, InputIt last) {
+        std::vector<std::pair<std::string_view, Value>> items(first, last);
+        Clear();
+        if (items.empty()) {
+            return;
+        }
+        //--при неудаче (крайне маловероятной) перестраиваем с другой солью
+        for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+            salt_ = Mix(attempt + 1);
+            if (TryBuild(items)) {
+                return;
+            }
+        }
+        throw std::logic_error("PerfectHashIndex::Build: can not build perfect hash (duplicate keys?)");
+    }
+
+    template <typename Value>
+    bool PerfectHashIndex<Value>::TryBuild(const std::vector<std::pair<std::string_view, Value>>& items) {
+        const size_t n = items.size();
+        const size_t bucket_count = (n + BUCKET_LOAD - 1) / BUCKET_LOAD;
+        keys_.assign(n, std::string_view{});
+        values_.assign(n, Value{});
+        seeds_.assign(bucket_count, 0);
+
+        std::vector<uint64_t> hashes(n);
+        std::vector<std::vector<size_t>> buckets(bucket_count);
+        for (size_t i = 0; i < n; ++i) {
+            hashes[i] = Hash(items[i].first, salt_);
+            buckets[hashes[i] % bucket_count].push_back(i);
+        }
+        //--сначала размещаем самые большие корзины, пока таблица свободна
+        std::vector<size_t> order(bucket_count);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&buckets](size_t lhs, size_t rhs) {
+            return buckets[lhs].size() > buckets[rhs].size();
+            });
+
+        std::vector<bool> occupied(n, false);
+        std::vector<size_t> slots;
+        for (size_t bucket : order) {
+            const auto& bucket_items = buckets[bucket];
+            if (bucket_items.empty()) {
+                break;
+            }
+            bool placed = false;
+            for (uint32_t seed = 0; seed < MAX_SEED && !placed; ++seed) {
+                slots.clear();
+                placed = true;
+                for (size_t item : bucket_items) {
+                    size_t slot = Slot(hashes[item], seed);
+                    if (occupied[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                        placed = false;
+                        break;
+                    }
+                    slots.push_back(slot);
+                }
+                if (placed) {
+                    seeds_[bucket] = seed;
+                }
+            }
+            if (!placed) {
+                return false;
+            }
+            for (size_t i = 0; i < bucket_items.size(); ++i) {
+                occupied[slots[i]] = true;
+                keys_[slots[i]] = items[bucket_items[i]].first;
+                values_[slots[i]] = items[bucket_items[i]].second;
+            }
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,97 @@
+#include "range_max_index.h"
+
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+
+namespace model {
+
+    void RangeMaxIndex::Build(std::vector<uint32_t> values) {
+        values_ = std::move(values);
+        levels_.clear();
+        if (values_.empty()) {
+            return;
+        }
+        std::vector<uint32_t>& base = levels_.emplace_back(values_.size());
+        for (size_t i = 0; i < values_.size(); ++i) {
+            base[i] = static_cast<uint32_t>(i);
+        }
+        for (size_t width = 2; width <= values_.size(); width *= 2) {
+            const std::vector<uint32_t>& prev = levels_.back();
+            std::vector<uint32_t> level(values_.size() - width + 1);
+            for (size_t i = 0; i < level.size(); ++i) {
+                level[i] = static_cast<uint32_t>(Better(prev[i], prev[i + width / 2]));
+            }
+            levels_.push_back(std::move(level));
+        }
+    }
+
+    void RangeMaxIndex::Clear() {
+        values_.clear();
+        levels_.clear();
+    }
+
+    size_t RangeMaxIndex::Size() const {
+        return values_.size();
+    }
+
+    uint32_t RangeMaxIndex::Get(size_t pos) const {
+        return values_[pos];
+    }
+
+    size_t RangeMaxIndex::Better(size_t lhs, size_t rhs) const {
+        if (values_[rhs] > values_[lhs] || (values_[rhs] == values_[lhs] && rhs < lhs)) {
+            return rhs;
+        }
+        return lhs;
+    }
+
+    size_t RangeMaxIndex::ArgMax(size_t first, size_t last) const {
+        if (first >= last || last > values_.size()) {
+            throw std::out_of_range("RangeMaxIndex::ArgMax: invalid range");
+        }
+        size_t level = 0;
+        while ((size_t{ 2 } << level) <= last - first) {
+            ++level;
+        }
+        return Better(levels_[level][first], levels_[level][last - (size_t{ 1 } << level)]);
+    }
+
+    std::vector<size_t> RangeMaxIndex::TopK(size_t first, size_t last, size_t count) const {
+        std::vector<size_t> result;
+        if (first >= last || count == 0) {
+            return result;
+        }
+        //--отрезки упорядочены по их максимуму, из равных раньше идёт левая позиция
+        using Candidate = std::tuple<uint32_t, size_t, size_t, size_t>;    // значение, позиция, first, last
+        const auto less = [](const Candidate& lhs, const Candidate& rhs) {
+            return std::get<0>(lhs) < std::get<0>(rhs)
+                || (std::get<0>(lhs) == std::get<0>(rhs) && std::get<1>(lhs) > std::get<1>(rhs));
+        };
+        std::priority_queue<Candidate, std::vector<Candidate>, decltype(less)> queue(less);
+        const auto push = [&](size_t from, size_t to) {
+            if (from < to) {
+                const size_t pos = ArgMax(from, to);
+                queue.emplace(values_[pos], pos, from, to);
+            }
+        };
+        push(first, last);
+        while (!queue.empty() && result.size() < count) {
+            const auto [value, pos, from, to] = queue.top();
+            queue.pop();
+            result.push_back(pos);
+            push(from, pos);
+            push(pos + 1, to);
+        }
+        return result;
+    }
+
+    size_t RangeMaxIndex::GetMemoryUsage() const {
+        size_t bytes = values_.capacity() * sizeof(uint32_t) + levels_.capacity() * sizeof(std::vector<uint32_t>);
+        for (const auto& level : levels_) {
+            bytes += level.capacity() * sizeof(uint32_t);
+        }
+        return bytes;
+    }
+
+}
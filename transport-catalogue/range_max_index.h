@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace model {
+
+    /**
+     * Разреженная таблица для поиска максимума на отрезке массива за O(1).
+     * levels_[k][i] — позиция максимума на [i, i + 2^k); из равных выбирается левая позиция.
+     */
+    class RangeMaxIndex {
+    public:
+        RangeMaxIndex() = default;
+
+        void Build(std::vector<uint32_t> values);
+        void Clear();
+
+        size_t Size() const;
+        uint32_t Get(size_t pos) const;
+        // Позиция максимума на непустом отрезке [first, last)
+        size_t ArgMax(size_t first, size_t last) const;
+        // Позиции не более count наибольших значений на [first, last) по убыванию значения,
+        // равные — по возрастанию позиции. O(count log count)
+        std::vector<size_t> TopK(size_t first, size_t last, size_t count) const;
+
+        // Байты, занимаемые значениями и уровнями таблицы
+        size_t GetMemoryUsage() const;
+
+    private:
+        size_t Better(size_t lhs, size_t rhs) const;
+
+        std::vector<uint32_t> values_;
+        std::vector<std::vector<uint32_t>> levels_;
+    };
+
+}
@@ -9,4 +9,68 @@
  */
 namespace handler {
 
-}
\ No newline at end of file
+    CatalogueVersion::CatalogueVersion(std::unique_ptr<model::TransportCatalogue> catalogue,
+        std::optional<renderer::RenderSettings> render_settings, std::optional<routing::RoutingSettings> routing_settings)
+        : catalogue_(std::move(catalogue))
+        , render_settings_(std::move(render_settings))
+        , routing_settings_(std::move(routing_settings)) {
+    }
+
+    const model::TransportCatalogue& CatalogueVersion::GetCatalogue() const {
+        return *catalogue_;
+    }
+
+    const renderer::MapRenderer* CatalogueVersion::GetRenderer() const {
+        if (!render_settings_) {
+            return nullptr;
+        }
+        std::call_once(renderer_once_, [this]() {
+            renderer_ = std::make_unique<renderer::MapRenderer>(*catalogue_, *render_settings_);
+            });
+        return renderer_.get();
+    }
+
+    const routing::TransportRouter* CatalogueVersion::GetRouter() const {
+        if (!routing_settings_) {
+            return nullptr;
+        }
+        std::call_once(router_once_, [this]() {
+            router_ = std::make_unique<routing::TransportRouter>(*catalogue_, *routing_settings_);
+            });
+        return router_.get();
+    }
+
+    std::unique_ptr<CatalogueVersion> BuildCatalogueVersion(std::unique_ptr<model::TransportCatalogue> catalogue,
+        std::optional<renderer::RenderSettings> render_settings, std::optional<routing::RoutingSettings> routing_settings) {
+        //--опубликованная версия не изменяется, поэтому справочник замораживается
+        catalogue->Freeze();
+        return std::make_unique<CatalogueVersion>(std::move(catalogue), std::move(render_settings), std::move(routing_settings));
+    }
+
+    std::shared_ptr<const CatalogueVersion> VersionedCatalogue::Acquire() const {
+        return std::atomic_load(&current_);
+    }
+
+    uint64_t VersionedCatalogue::Publish(std::unique_ptr<CatalogueVersion> next) {
+        std::lock_guard guard(writer_mutex_);
+        next->number = ++last_number_;
+        std::shared_ptr<const CatalogueVersion> published(std::move(next));
+        auto previous = std::atomic_exchange(&current_, published);
+        if (previous) {
+            retired_.push_back(std::move(previous));
+        }
+        return published->number;
+    }
+
+    size_t VersionedCatalogue::CollectRetired() {
+        std::lock_guard guard(writer_mutex_);
+        //--версия уже не текущая, поэтому новых читателей у неё не появится
+        auto it = std::remove_if(retired_.begin(), retired_.end(), [](const auto& version) {
+            return version.use_count() == 1;
+            });
+        size_t collected = std::distance(it, retired_.end());
+        retired_.erase(it, retired_.end());
+        return collected;
+    }
+
+}
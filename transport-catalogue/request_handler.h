@@ -3,36 +3,76 @@
 #include "transport_catalogue.h"
 #include "transport_router.h"
 #include "map_renderer.h"
-#include <unordered_set>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <vector>
 
 
 // Класс RequestHandler играет роль Фасада, упрощающего взаимодействие JSON reader-а
 // с другими подсистемами приложения.
 // См. паттерн проектирования Фасад: https://ru.wikipedia.org/wiki/Фасад_(шаблон_проектирования)
-/*
 namespace handler {
 
-    class RequestHandler {
+    /**
+     * Одна версия справочника вместе с производными структурами (маршрутизатор, визуализатор).
+     * После публикации версия не изменяется, поэтому читатели работают с ней без блокировок.
+     * Маршрутизатор и визуализатор строятся при первом обращении и затем общие для всех читателей:
+     * таблица маршрутов между всеми парами вершин не нужна пакетам без запросов Route
+     */
+    class CatalogueVersion {
     public:
-        // MapRenderer понадобится в следующей части итогового проекта
-        RequestHandler(const model::TransportCatalogue& db, const renderer::MapRenderer& renderer);
+        CatalogueVersion(std::unique_ptr<model::TransportCatalogue> catalogue,
+            std::optional<renderer::RenderSettings> render_settings, std::optional<routing::RoutingSettings> routing_settings);
 
-        // Возвращает информацию о маршруте (запрос Bus)
-        std::optional<model::RouteInfo> GetBusStat(const std::string_view& bus_name) const;
+        const model::TransportCatalogue& GetCatalogue() const;
+        // nullptr, если для версии не заданы настройки визуализации
+        const renderer::MapRenderer* GetRenderer() const;
+        // nullptr, если для версии не заданы настройки маршрутизации
+        const routing::TransportRouter* GetRouter() const;
 
-        // Возвращает маршруты, проходящие через
-        const std::unordered_set<BusPtr>* GetBusesByStop(std::string_view stop_name) const;
+        uint64_t number = 0;
 
-        // Этот метод будет нужен в следующей части итогового проекта
-        svg::Document RenderMap() const;
+    private:
+        std::unique_ptr<model::TransportCatalogue> catalogue_;
+        //--настройки хранятся в версии: MapRenderer держит ссылку на них
+        std::optional<renderer::RenderSettings> render_settings_;
+        std::optional<routing::RoutingSettings> routing_settings_;
+        mutable std::once_flag renderer_once_;
+        mutable std::unique_ptr<renderer::MapRenderer> renderer_;
+        mutable std::once_flag router_once_;
+        mutable std::unique_ptr<routing::TransportRouter> router_;
+    };
+
+    /**
+     * Строит версию вокруг заполненного справочника и замораживает его.
+     */
+    std::unique_ptr<CatalogueVersion> BuildCatalogueVersion(std::unique_ptr<model::TransportCatalogue> catalogue,
+        std::optional<renderer::RenderSettings> render_settings, std::optional<routing::RoutingSettings> routing_settings);
+
+    /**
+     * Хранилище текущей версии справочника (схема RCU).
+     * Писатель готовит следующую версию в стороне и публикует её одной атомарной заменой указателя.
+     * Читатель захватывает shared_ptr и работает со своей версией до конца запроса.
+     * Вытесненные версии освобождаются в потоке писателя, когда их отпустят все читатели.
+     */
+    class VersionedCatalogue {
+    public:
+        VersionedCatalogue() = default;
+
+        std::shared_ptr<const CatalogueVersion> Acquire() const;
+        // Публикует версию, присваивает ей очередной номер и возвращает его
+        uint64_t Publish(std::unique_ptr<CatalogueVersion> next);
+        // Освобождает вытесненные версии, которые больше никто не читает
+        size_t CollectRetired();
 
     private:
-        // RequestHandler использует агрегацию объектов "Транспортный Справочник" и "Визуализатор Карты"
-        const model::TransportCatalogue& db_;
-        const renderer::MapRenderer& renderer_;
+        std::shared_ptr<const CatalogueVersion> current_;
+        std::mutex writer_mutex_;
+        std::vector<std::shared_ptr<const CatalogueVersion>> retired_;
+        uint64_t last_number_ = 0;
     };
 
 }
-*/
-
@@ -6,6 +6,7 @@
 #include <cassert>
 #include <cstdint>
 #include <iterator>
+#include <memory_resource>
 #include <optional>
 #include <stdexcept>
 #include <unordered_map>
@@ -20,7 +21,8 @@ private:
     using Graph = DirectedWeightedGraph<Weight>;
 
 public:
-    explicit Router(const Graph& graph);
+    // Таблица маршрутов размещается в resource
+    explicit Router(const Graph& graph, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
     struct RouteInfo {
         Weight weight;
@@ -29,13 +31,16 @@ public:
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
+    // Байты, занимаемые таблицей маршрутов между всеми парами вершин
+    size_t GetMemoryUsage() const;
+
 private:
     struct RouteInternalData {
         Weight weight;
         std::optional<EdgeId> prev_edge;
     };
                                 //vertex_from   vertex_to
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+    using RoutesInternalData = std::pmr::vector<std::pmr::vector<std::optional<RouteInternalData>>>;
 
     void InitializeRoutesInternalData(const Graph& graph) {
         const size_t vertex_count = graph.GetVertexCount();
@@ -82,19 +87,32 @@ private:
 };
 
 template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+Router<Weight>::Router(const Graph& graph, std::pmr::memory_resource* resource)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    , routes_internal_data_(resource)
 {
+    //--строки создаются на месте: копирование строки-образца оставило бы её в арене мёртвым блоком
+    const size_t vertex_count = graph.GetVertexCount();
+    routes_internal_data_.reserve(vertex_count);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        routes_internal_data_.emplace_back(vertex_count);
+    }
     InitializeRoutesInternalData(graph);
 
-    const size_t vertex_count = graph.GetVertexCount();
     for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
         RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
     }
 }
 
+template <typename Weight>
+size_t Router<Weight>::GetMemoryUsage() const {
+    size_t bytes = routes_internal_data_.capacity() * sizeof(typename RoutesInternalData::value_type);
+    for (const auto& routes_from : routes_internal_data_) {
+        bytes += routes_from.capacity() * sizeof(std::optional<RouteInternalData>);
+    }
+    return bytes;
+}
+
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
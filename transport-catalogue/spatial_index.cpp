@@ -0,0 +1,190 @@
+#define _USE_MATH_DEFINES
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace geo {
+
+    namespace {
+        constexpr double EARTH_RADIUS = 6371000;
+        constexpr double DR = M_PI / 180.0;
+        constexpr double METERS_PER_DEGREE = EARTH_RADIUS * DR;
+        // Среднее число точек в ячейке
+        constexpr size_t POINTS_PER_CELL = 2;
+        constexpr size_t MAX_SIDE_CELLS = 4096;
+        // Запас на отличие расстояния по дуге от оценки в градусах
+        constexpr double DEGREE_MARGIN = 1.01;
+        constexpr double BOUND_MARGIN = 0.99;
+        constexpr double MIN_CELL_DEGREES = 1e-9;
+
+        bool NearLess(const GridIndex::Neighbor& lhs, const GridIndex::Neighbor& rhs) {
+            return lhs.distance < rhs.distance || (lhs.distance == rhs.distance && lhs.id < rhs.id);
+        }
+    }
+
+    GridIndex::GridIndex(const CoordinatesTable& points) {
+        const size_t n = points.Size();
+        if (n == 0) {
+            cell_offsets_.assign(1, 0);
+            return;
+        }
+        min_lat_ = max_lat_ = points.Get(0).lat;
+        min_lng_ = max_lng_ = points.Get(0).lng;
+        for (PointId id = 1; id < n; ++id) {
+            const Coordinates coord = points.Get(id);
+            min_lat_ = std::min(min_lat_, coord.lat);
+            max_lat_ = std::max(max_lat_, coord.lat);
+            min_lng_ = std::min(min_lng_, coord.lng);
+            max_lng_ = std::max(max_lng_, coord.lng);
+        }
+        max_abs_lat_ = std::max(std::abs(min_lat_), std::abs(max_lat_));
+
+        //--ячейки делаем примерно квадратными на местности
+        const double height = max_lat_ - min_lat_;
+        const double width = (max_lng_ - min_lng_) * std::cos((min_lat_ + max_lat_) / 2 * DR);
+        const double target_cells = static_cast<double>(std::max<size_t>(1, n / POINTS_PER_CELL));
+        double side = std::sqrt(height * width / target_cells);
+        if (side < MIN_CELL_DEGREES) {
+            side = std::max(height, width) / target_cells;
+        }
+        if (side < MIN_CELL_DEGREES) {
+            rows_ = cols_ = 1;
+        } else {
+            rows_ = std::clamp<size_t>(static_cast<size_t>(std::ceil(height / side)), 1, MAX_SIDE_CELLS);
+            cols_ = std::clamp<size_t>(static_cast<size_t>(std::ceil(width / side)), 1, MAX_SIDE_CELLS);
+        }
+        cell_lat_ = std::max(height / rows_, MIN_CELL_DEGREES);
+        cell_lng_ = std::max((max_lng_ - min_lng_) / cols_, MIN_CELL_DEGREES);
+
+        //--сортировка подсчётом по ячейкам
+        std::vector<size_t> point_cells(n);
+        cell_offsets_.assign(rows_ * cols_ + 1, 0);
+        for (PointId id = 0; id < n; ++id) {
+            const Coordinates coord = points.Get(id);
+            point_cells[id] = GetCell(GetRow(coord.lat), GetCol(coord.lng));
+            ++cell_offsets_[point_cells[id] + 1];
+        }
+        for (size_t cell = 0; cell < rows_ * cols_; ++cell) {
+            cell_offsets_[cell + 1] += cell_offsets_[cell];
+        }
+        std::vector<size_t> positions(cell_offsets_.begin(), cell_offsets_.end() - 1);
+        ids_.resize(n);
+        for (PointId id = 0; id < n; ++id) {
+            ids_[positions[point_cells[id]]++] = id;
+        }
+        points_.Reserve(n);
+        for (PointId id : ids_) {
+            points_.Add(points.Get(id));
+        }
+    }
+
+    size_t GridIndex::Size() const {
+        return ids_.size();
+    }
+
+    size_t GridIndex::GetMemoryUsage() const {
+        return cell_offsets_.capacity() * sizeof(size_t) + ids_.capacity() * sizeof(PointId) + points_.GetMemoryUsage();
+    }
+
+    size_t GridIndex::GetRow(double lat) const {
+        const double row = std::floor((lat - min_lat_) / cell_lat_);
+        return static_cast<size_t>(std::clamp(row, 0.0, static_cast<double>(rows_ - 1)));
+    }
+
+    size_t GridIndex::GetCol(double lng) const {
+        const double col = std::floor((lng - min_lng_) / cell_lng_);
+        return static_cast<size_t>(std::clamp(col, 0.0, static_cast<double>(cols_ - 1)));
+    }
+
+    GridIndex::CellRange GridIndex::GetCellRange(Coordinates center, double radius) const {
+        const double dlat = radius / METERS_PER_DEGREE * DEGREE_MARGIN;
+        const double extreme_lat = std::min(90.0, std::max(std::abs(center.lat), max_abs_lat_) + dlat);
+        const double cos_lat = std::cos(extreme_lat * DR);
+        const double dlng = cos_lat > 1e-9 ? dlat / cos_lat : 360.0;
+        if (center.lat + dlat < min_lat_ || center.lat - dlat > max_lat_
+            || center.lng + dlng < min_lng_ || center.lng - dlng > max_lng_) {
+            return { 0, 0, 0, 0 };
+        }
+        return { GetRow(center.lat - dlat), GetRow(center.lat + dlat) + 1,
+            GetCol(center.lng - dlng), GetCol(center.lng + dlng) + 1 };
+    }
+
+    double GridIndex::GetRingBound(size_t ring) const {
+        const double cell_height = cell_lat_ * METERS_PER_DEGREE;
+        const double cell_width = cell_lng_ * METERS_PER_DEGREE * std::cos(std::min(90.0, max_abs_lat_) * DR);
+        return ring * std::min(cell_height, cell_width) * BOUND_MARGIN;
+    }
+
+    std::vector<GridIndex::Neighbor> GridIndex::FindNearby(Coordinates center, double radius, size_t count) const {
+        std::vector<Neighbor> result;
+        if (ids_.empty() || count == 0 || radius < 0) {
+            return result;
+        }
+        const TrigCoordinates query(center);
+        auto scan_cells = [&](size_t first_cell, size_t last_cell) {
+            for (size_t i = cell_offsets_[first_cell]; i < cell_offsets_[last_cell + 1]; ++i) {
+                const double distance = points_.ComputeDistance(query, i);
+                if (distance <= radius) {
+                    result.push_back({ ids_[i], distance });
+                }
+            }
+        };
+
+        if (std::isfinite(radius) && count == std::numeric_limits<size_t>::max()) {
+            //--только радиус: просматриваем прямоугольник ячеек
+            const CellRange range = GetCellRange(center, radius);
+            for (size_t row = range.row_begin; row < range.row_end; ++row) {
+                scan_cells(GetCell(row, range.col_begin), GetCell(row, range.col_end - 1));
+            }
+            std::sort(result.begin(), result.end(), NearLess);
+            return result;
+        }
+
+        //--k ближайших: расширяем квадрат ячеек кольцами, пока оценка не гарантирует ответ
+        const long long center_row = static_cast<long long>(GetRow(center.lat));
+        const long long center_col = static_cast<long long>(GetCol(center.lng));
+        const long long rows = static_cast<long long>(rows_);
+        const long long cols = static_cast<long long>(cols_);
+        const size_t max_ring = std::max(rows_, cols_);
+        for (size_t ring = 0; ring <= max_ring; ++ring) {
+            const long long r = static_cast<long long>(ring);
+            const long long col_begin = std::max(0ll, center_col - r);
+            const long long col_end = std::min(cols - 1, center_col + r);
+            for (long long row = std::max(0ll, center_row - r); row <= std::min(rows - 1, center_row + r); ++row) {
+                if (std::abs(row - center_row) == r) {
+                    if (col_begin <= col_end) {
+                        scan_cells(GetCell(row, col_begin), GetCell(row, col_end));
+                    }
+                    continue;
+                }
+                if (center_col - r >= 0) {
+                    scan_cells(GetCell(row, center_col - r), GetCell(row, center_col - r));
+                }
+                if (r > 0 && center_col + r < cols) {
+                    scan_cells(GetCell(row, center_col + r), GetCell(row, center_col + r));
+                }
+            }
+
+            const double bound = GetRingBound(ring);
+            if (bound > radius) {
+                break;
+            }
+            if (result.size() >= count) {
+                std::nth_element(result.begin(), result.begin() + (count - 1), result.end(), NearLess);
+                if (result[count - 1].distance <= bound) {
+                    break;
+                }
+            }
+        }
+
+        if (result.size() > count) {
+            std::partial_sort(result.begin(), result.begin() + count, result.end(), NearLess);
+            result.resize(count);
+        } else {
+            std::sort(result.begin(), result.end(), NearLess);
+        }
+        return result;
+    }
+
+}  // namespace geo
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "geo.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace geo {
+
+    /**
+     * Равномерная сетка по широте и долготе над набором точек.
+     * Строится один раз; точки хранятся упорядоченными по ячейкам (формат CSR),
+     * вместе с их тригонометрией, так что запрос читает память подряд.
+     * Рассчитана на масштаб города: переход через 180-й меридиан не учитывается.
+     */
+    class GridIndex {
+    public:
+        using PointId = CoordinatesTable::PointId;
+
+        struct Neighbor {
+            PointId id;
+            double distance;    // м
+        };
+
+        GridIndex() = default;
+        explicit GridIndex(const CoordinatesTable& points);
+
+        // Точки не дальше radius метров от center (не более count), по возрастанию расстояния
+        std::vector<Neighbor> FindNearby(Coordinates center,
+            double radius = std::numeric_limits<double>::infinity(),
+            size_t count = std::numeric_limits<size_t>::max()) const;
+
+        // Перебирает пары разных точек на расстоянии не более radius метров, каждую пару один раз:
+        // callback(id1, id2, distance)
+        template <typename Callback>
+        void ForEachPairWithin(double radius, Callback callback) const;
+
+        size_t Size() const;
+        // Байты, занимаемые ячейками и копией точек
+        size_t GetMemoryUsage() const;
+
+    private:
+        struct CellRange {
+            size_t row_begin;
+            size_t row_end;
+            size_t col_begin;
+            size_t col_end;
+        };
+
+        size_t GetRow(double lat) const;
+        size_t GetCol(double lng) const;
+        // Ячейки, покрывающие окрестность радиуса radius вокруг center
+        CellRange GetCellRange(Coordinates center, double radius) const;
+        size_t GetCell(size_t row, size_t col) const {
+            return row * cols_ + col;
+        }
+        // Нижняя оценка расстояния до точек вне квадрата ячеек радиуса ring вокруг ячейки запроса
+        double GetRingBound(size_t ring) const;
+
+        size_t rows_ = 0;
+        size_t cols_ = 0;
+        double min_lat_ = 0.;
+        double min_lng_ = 0.;
+        double max_lat_ = 0.;
+        double max_lng_ = 0.;
+        double cell_lat_ = 1.;  // размер ячейки в градусах
+        double cell_lng_ = 1.;
+        double max_abs_lat_ = 0.;
+        std::vector<size_t> cell_offsets_;
+        std::vector<PointId> ids_;
+        // Точки в порядке ячеек
+        CoordinatesTable points_;
+    };
+
+    template <typename Callback>
+    void GridIndex::ForEachPairWithin(double radius, Callback callback) const {
+        //--пару находим из точки, стоящей раньше в порядке ячеек: окрестности симметричны
+        for (size_t i = 0; i < ids_.size(); ++i) {
+            const CellRange range = GetCellRange(points_.Get(i), radius);
+            for (size_t row = range.row_begin; row < range.row_end; ++row) {
+                const size_t first_cell = GetCell(row, range.col_begin);
+                const size_t last_cell = GetCell(row, range.col_end - 1);
+                for (size_t j = std::max(cell_offsets_[first_cell], i + 1); j < cell_offsets_[last_cell + 1]; ++j) {
+                    const double distance = points_.ComputeDistance(i, j);
+                    if (distance <= radius) {
+                        callback(ids_[i], ids_[j], distance);
+                    }
+                }
+            }
+        }
+    }
+
+}  // namespace geo
@@ -0,0 +1,98 @@
+#include "string_arena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+namespace model {
+
+    std::string_view StringArena::Append(std::string_view str) {
+        if (blocks_.empty() || blocks_.back().capacity - blocks_.back().size < str.size()) {
+            Block block;
+            block.capacity = std::max(BLOCK_CAPACITY, str.size());
+            block.storage = std::make_unique<char[]>(block.capacity);
+            block.data = block.storage.get();
+            AddBlock(std::move(block));
+        }
+        Block& block = blocks_.back();
+        char* dest = block.data + block.size;
+        std::memcpy(dest, str.data(), str.size());
+        block.size += str.size();
+        return { dest, str.size() };
+    }
+
+    size_t StringArena::Adopt(std::string_view pool, std::shared_ptr<const void> owner) {
+        Block block;
+        //--блок заполнен целиком, поэтому Append в него не пишет и const_cast безопасен
+        block.data = const_cast<char*>(pool.data());
+        block.capacity = pool.size();
+        block.size = pool.size();
+        block.owner = std::move(owner);
+        const size_t offset = Size();
+        AddBlock(std::move(block));
+        return offset;
+    }
+
+    void StringArena::AddBlock(Block block) {
+        block.offset = Size();
+        const std::less<const char*> less;
+        const auto pos = std::upper_bound(blocks_by_address_.begin(), blocks_by_address_.end(), block.data,
+            [this, less](const char* data, size_t index) {
+                return less(data, blocks_[index].data);
+            });
+        blocks_by_address_.insert(pos, blocks_.size());
+        blocks_.push_back(std::move(block));
+    }
+
+    StringArena::Ref StringArena::GetRef(std::string_view stored) const {
+        const std::less<const char*> less;
+        //--последний блок, начинающийся не дальше строки
+        const auto it = std::upper_bound(blocks_by_address_.begin(), blocks_by_address_.end(), stored.data(),
+            [this, less](const char* data, size_t index) {
+                return less(data, blocks_[index].data);
+            });
+        if (it != blocks_by_address_.begin()) {
+            const Block& block = blocks_[*std::prev(it)];
+            const char* begin = block.data;
+            if (!less(begin + block.size, stored.data() + stored.size())) {
+                const size_t offset = block.offset + (stored.data() - begin);
+                if (offset + stored.size() > std::numeric_limits<uint32_t>::max()) {
+                    throw std::length_error("StringArena::GetRef: offset does not fit into 32 bits");
+                }
+                return { static_cast<uint32_t>(offset), static_cast<uint32_t>(stored.size()) };
+            }
+        }
+        throw std::logic_error("StringArena::GetRef: string is not stored in arena");
+    }
+
+    std::string_view StringArena::Resolve(Ref ref) const {
+        auto it = std::upper_bound(blocks_.begin(), blocks_.end(), ref.offset, [](size_t offset, const Block& block) {
+            return offset < block.offset;
+            });
+        if (it == blocks_.begin()) {
+            throw std::out_of_range("StringArena::Resolve: offset is out of arena");
+        }
+        const Block& block = *std::prev(it);
+        if (ref.offset - block.offset + ref.length > block.size) {
+            throw std::out_of_range("StringArena::Resolve: string is out of arena");
+        }
+        return { block.data + (ref.offset - block.offset), ref.length };
+    }
+
+    size_t StringArena::Size() const {
+        return blocks_.empty() ? 0 : blocks_.back().offset + blocks_.back().size;
+    }
+
+    size_t StringArena::GetMemoryUsage() const {
+        size_t bytes = blocks_.capacity() * sizeof(Block) + blocks_by_address_.capacity() * sizeof(size_t);
+        for (const auto& block : blocks_) {
+            if (block.storage) {
+                bytes += block.capacity;
+            }
+        }
+        return bytes;
+    }
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace model {
+
+    /**
+     * Хранилище строк, в которое можно только дописывать.
+     * Строки лежат подряд в крупных блоках, поэтому string_view на них не инвалидируются.
+     * Каждая строка адресуется парой (смещение, длина) в общей последовательности байт арены:
+     * содержимое арены можно выгрузить одним пулом строк (см. catalogue_snapshot).
+     */
+    class StringArena {
+    public:
+        struct Ref {
+            uint32_t offset = 0;
+            uint32_t length = 0;
+        };
+
+        StringArena() = default;
+        StringArena(const StringArena&) = delete;
+        StringArena& operator=(const StringArena&) = delete;
+        StringArena(StringArena&&) = default;
+        StringArena& operator=(StringArena&&) = default;
+
+        // Копирует строку в арену и возвращает view на копию
+        std::string_view Append(std::string_view str);
+        // Подключает внешний неизменяемый пул строк (например, отображённый в память снимок) как очередной блок
+        // без копирования: owner держит пул живым, пока жива арена. Ref-смещения строк пула сдвигаются
+        // на возвращённое значение (0 для пустой арены). Последующие Append пишут уже в новые блоки
+        size_t Adopt(std::string_view pool, std::shared_ptr<const void> owner);
+
+        // Адрес строки, ранее возвращённой Append (двоичный поиск блока по адресу).
+        // std::length_error, если смещение не помещается в 32 бита Ref
+        Ref GetRef(std::string_view stored) const;
+        std::string_view Resolve(Ref ref) const;
+
+        // Общий объём строк в байтах
+        size_t Size() const;
+        // Байты, занимаемые собственными блоками арены вместе с незаполненными остатками (без внешних пулов)
+        size_t GetMemoryUsage() const;
+
+        // Перебирает заполненные части блоков в порядке возрастания смещений
+        template <typename Callback>
+        void ForEachBlock(Callback callback) const {
+            for (const auto& block : blocks_) {
+                callback(std::string_view{ block.data, block.size });
+            }
+        }
+
+    private:
+        static constexpr size_t BLOCK_CAPACITY = 64 * 1024;
+
+        struct Block {
+            char* data = nullptr;
+            //--память собственного блока; у внешнего пула пусто, а его время жизни продлевает owner
+            std::unique_ptr<char[]> storage;
+            std::shared_ptr<const void> owner;
+            size_t capacity = 0;
+            size_t size = 0;
+            // Смещение начала блока в общей последовательности байт
+            size_t offset = 0;
+        };
+
+        void AddBlock(Block block);
+
+        std::vector<Block> blocks_;
+        //--номера блоков по возрастанию адреса их данных
+        std::vector<size_t> blocks_by_address_;
+    };
+
+}
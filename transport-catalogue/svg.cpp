@@ -1,16 +1,24 @@
 #include "svg.h"
 
+#include <charconv>
+
 namespace svg {
 
     using namespace std::literals;
 
+    void WriteNumber(std::ostream& out, double value) {
+        char buffer[32];
+        const auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value, std::chars_format::general, 6);
+        out.write(buffer, end - buffer);
+    }
+
     void Object::Render(const RenderContext& context) const {
         context.RenderIndent();
 
         // Делегируем вывод тега своим подклассам
         RenderObject(context);
 
-        context.out << std::endl;
+        context.out << '\n';
     }
 
     // ---------- Circle ------------------
@@ -25,10 +33,19 @@ namespace svg {
         return *this;
     }
 
+    size_t Circle::GetMemoryUsage() const {
+        return sizeof(Circle) + GetPropsMemoryUsage();
+    }
+
     void Circle::RenderObject(const RenderContext& context) const {
         auto& out = context.out;
-        out << "<circle cx=\""sv << center_.x << "\" cy=\""sv << center_.y << "\" "sv;
-        out << "r=\""sv << radius_ << "\" "sv;
+        out << "<circle cx=\""sv;
+        WriteNumber(out, center_.x);
+        out << "\" cy=\""sv;
+        WriteNumber(out, center_.y);
+        out << "\" r=\""sv;
+        WriteNumber(out, radius_);
+        out << "\" "sv;
         // Выводим атрибуты, унаследованные от PathProps
         RenderAttrs(context.out);
         out << "/>"sv;
@@ -105,7 +122,9 @@ namespace svg {
 
     void ColorPrinter::operator()(Rgba rgba) const {
         out << "rgba("s << static_cast<int>(rgba.red) << ","s << static_cast<int>(rgba.green)
-            << ","s << static_cast<int>(rgba.blue) << ","s << rgba.opacity << ")"s;
+            << ","s << static_cast<int>(rgba.blue) << ","s;
+        WriteNumber(out, rgba.opacity);
+        out << ")"s;
     }
 
     Polyline& Polyline::AddPoint(Point point) {
@@ -113,6 +132,10 @@ namespace svg {
         return *this;
     }
 
+    size_t Polyline::GetMemoryUsage() const {
+        return sizeof(Polyline) + GetPropsMemoryUsage() + points_.capacity() * sizeof(Point);
+    }
+
     void Polyline::RenderObject(const RenderContext& context) const {
         //<polyline points = "20,40 22.9389,45.9549 29.5106,46.9098 24.7553,
         //51.5451 25.8779,58.0902 20,55 14.1221,58.0902 15.2447,51.5451 10.4894,
@@ -125,13 +148,26 @@ namespace svg {
                 out << " ";
             }
             first = false;
-            out << point.x << ',' << point.y;
+            WriteNumber(out, point.x);
+            out.put(',');
+            WriteNumber(out, point.y);
         }
         out << "\" "sv;
         RenderAttrs(context.out);
         out << "/>"sv;
     }
 
+    size_t Text::GetMemoryUsage() const {
+        size_t bytes = sizeof(Text) + GetPropsMemoryUsage()
+            + model::StringHeapBytes(font_family_) + model::StringHeapBytes(data_) + model::StringHeapBytes(font_weight_);
+        //--таблица замен для экранирования хранится в каждом объекте
+        bytes += simbols_.bucket_count() * sizeof(void*);
+        for (const auto& [c, replacement] : simbols_) {
+            bytes += 2 * sizeof(void*) + sizeof(std::pair<const char, std::string>) + model::StringHeapBytes(replacement);
+        }
+        return bytes;
+    }
+
     std::string Text::ToEscapeCharacters(const std::string& str) const {
         std::string result;
         for (const auto& c : str) {
@@ -151,9 +187,15 @@ namespace svg {
         auto& out = context.out;
         out << "<text";
         RenderAttrs(context.out);
-        out << " x=\"" << pos_.x << "\" y=\"" << pos_.y
-            << "\" dx=\"" << offset_.x << "\" dy=\"" << offset_.y
-            << "\" font-size=\"" << size_ << "\"";
+        out << " x=\""sv;
+        WriteNumber(out, pos_.x);
+        out << "\" y=\""sv;
+        WriteNumber(out, pos_.y);
+        out << "\" dx=\""sv;
+        WriteNumber(out, offset_.x);
+        out << "\" dy=\""sv;
+        WriteNumber(out, offset_.y);
+        out << "\" font-size=\"" << size_ << "\"";
         if (!font_family_.empty()) {
             out << " font-family=\"" << font_family_ << "\"";
         }
@@ -170,9 +212,21 @@ namespace svg {
         objects_.emplace_back(std::move(obj));
     }
 
+    size_t Document::GetObjectCount() const {
+        return objects_.size();
+    }
+
+    size_t Document::GetMemoryUsage() const {
+        size_t bytes = objects_.capacity() * sizeof(std::unique_ptr<Object>);
+        for (const auto& obj : objects_) {
+            bytes += obj->GetMemoryUsage();
+        }
+        return bytes;
+    }
+
     void Document::Render(std::ostream& out) const {
-        out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << std::endl;
-        out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << std::endl;
+        out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << '\n';
+        out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << '\n';
 
         RenderContext ctx(out, 2, 2);
         for (const auto& obj : objects_) {
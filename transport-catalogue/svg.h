@@ -1,5 +1,7 @@
 #pragma once
 
+#include "memory_report.h"
+
 #include <cstdint>
 #include <iostream>
 #include <memory>
@@ -69,6 +71,10 @@ namespace svg {
     std::ostream& operator<<(std::ostream& out, StrokeLineJoin line_join);
     std::ostream& operator<<(std::ostream& out, Color color);
 
+    // Выводит число так же, как operator<< с настройками потока по умолчанию (%g, 6 значащих цифр),
+    // но через to_chars: без локали и без выделений памяти
+    void WriteNumber(std::ostream& out, double value);
+
     template <typename Owner>
     class PathProps {
     public:
@@ -99,6 +105,17 @@ namespace svg {
     protected:
         ~PathProps() = default;
 
+        // Байты в куче, занятые строковыми цветами
+        size_t GetPropsMemoryUsage() const {
+            size_t bytes = 0;
+            for (const auto* color : { &fill_color_, &stroke_color_ }) {
+                if (*color && std::holds_alternative<std::string>(**color)) {
+                    bytes += model::StringHeapBytes(std::get<std::string>(**color));
+                }
+            }
+            return bytes;
+        }
+
         // Метод RenderAttrs выводит в поток общие для всех путей атрибуты fill и stroke
         void RenderAttrs(std::ostream& out) const {
             using namespace std::literals;
@@ -110,7 +127,9 @@ namespace svg {
                 out << " stroke=\""sv << *stroke_color_ << "\""sv;
             }
             if (stroke_width_) {
-                out << " stroke-width=\""sv << *stroke_width_ << "\""sv;
+                out << " stroke-width=\""sv;
+                WriteNumber(out, *stroke_width_);
+                out << "\""sv;
             }
             if (line_cap_) {
                 out << " stroke-linecap=\""sv << *line_cap_ << "\""sv;
@@ -184,6 +203,8 @@ namespace svg {
     class Object {
     public:
         void Render(const RenderContext& context) const;
+        // Байты, занимаемые объектом вместе с его данными в куче
+        virtual size_t GetMemoryUsage() const = 0;
 
         virtual ~Object() = default;
 
@@ -219,6 +240,7 @@ namespace svg {
         Circle() = default;
         Circle& SetCenter(Point center);
         Circle& SetRadius(double radius);
+        size_t GetMemoryUsage() const override;
 
     private:
         //void RenderObject(const RenderContext& context) const override;
@@ -238,6 +260,7 @@ namespace svg {
 
         // Добавляет очередную вершину к ломаной линии
         Polyline& AddPoint(Point point);
+        size_t GetMemoryUsage() const override;
 
     private:
         void RenderObject(const RenderContext& context) const override;
@@ -288,6 +311,8 @@ namespace svg {
             return *this;
         }
 
+        size_t GetMemoryUsage() const override;
+
     private:
         std::string ToEscapeCharacters(const std::string& str) const;
         void RenderObject(const RenderContext& context) const override;
@@ -310,6 +335,10 @@ namespace svg {
         // Выводит в ostream svg-представление документа
         void Render(std::ostream& out) const;
 
+        size_t GetObjectCount() const;
+        // Байты, занимаемые документом и всеми его объектами
+        size_t GetMemoryUsage() const;
+
     private:
         std::vector<std::unique_ptr<Object>> objects_;
     };
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * Байтовые проверки над 64-битным словом (SWAR): 8 символов буфера обрабатываются
+ * одной арифметической операцией без векторных инструкций.
+ */
+
+namespace swar {
+
+inline constexpr uint64_t ONES = 0x0101010101010101ull;
+inline constexpr uint64_t HIGHS = 0x8080808080808080ull;
+
+// Старшие биты байтов слова, равных byte (младший установленный бит точен)
+inline uint64_t MatchByte(uint64_t word, unsigned char byte) {
+    const uint64_t x = word ^ (ONES * byte);
+    return (x - ONES) & ~x & HIGHS;
+}
+
+// Старшие биты байтов слова, меньших bound (bound <= 128)
+inline uint64_t MatchLess(uint64_t word, unsigned char bound) {
+    return (word - ONES * bound) & ~word & HIGHS;
+}
+
+inline uint64_t LoadWord(const char* ptr) {
+    uint64_t word;
+    std::memcpy(&word, ptr, sizeof(word));
+    return word;
+}
+
+// Номер первого байта слова, отмеченного в mask
+inline size_t FirstMarked(uint64_t mask) {
+#if defined(__GNUC__)
+    return static_cast<size_t>(__builtin_ctzll(mask)) / 8;
+#else
+    size_t idx = 0;
+    for (; (mask & 0x80) == 0; mask >>= 8) {
+        ++idx;
+    }
+    return idx;
+#endif
+}
+
+// Длина начального отрезка [begin, end) без '"', '\\' и управляющих символов —
+// символов, которые в строке JSON требуют особой обработки
+inline size_t FindStringSpecial(const char* begin, const char* end) {
+    const char* ptr = begin;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; end - ptr >= 8; ptr += 8) {
+        const uint64_t word = LoadWord(ptr);
+        const uint64_t mask = MatchByte(word, '"') | MatchByte(word, '\\') | MatchLess(word, 0x20);
+        if (mask != 0) {
+            return ptr - begin + FirstMarked(mask);
+        }
+    }
+#endif
+    while (ptr != end && *ptr != '"' && *ptr != '\\' && static_cast<unsigned char>(*ptr) >= 0x20) {
+        ++ptr;
+    }
+    return ptr - begin;
+}
+
+}  // namespace swar
@@ -0,0 +1,138 @@
+#include "../json.h"
+#include "../json_flat.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Плоский документ совпадает с деревом json::Load (значения, порядок ключей, ошибки разбора),
+ * строки без escape-последовательностей остаются view на входной буфер, а построение большого
+ * документа обходится несколькими крупными выделениями памяти вместо выделения на каждый узел.
+ */
+
+namespace {
+
+size_t allocation_count = 0;
+
+bool failed = false;
+
+void Check(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cerr << "FAILED: " << message << '\n';
+        failed = true;
+    }
+}
+
+// Дерево документа или текст ошибки разбора
+template <typename Load>
+std::pair<std::optional<json::Node>, std::string> TryLoad(Load load) {
+    try {
+        return { load(), {} };
+    } catch (const json::ParsingError& e) {
+        return { std::nullopt, e.what() };
+    }
+}
+
+void TestSameAsLoad() {
+    const std::vector<std::string> documents = {
+        R"(null)",
+        R"([])",
+        R"({})",
+        R"(  [1, -2, 3.5, 1e3, 2147483648, true, false, null, "x"]  )",
+        R"({"b": {"y": [1, {"z": null}], "x": "\"quoted\"\n"}, "a": [], "c": {}})",
+        R"({"key\twith\\escapes": "value", "plain": "text"})",
+        R"([[[[["deep"]]]], {"k": [{"k": [{"k": 0}]}]}])",
+        R"({"dup": 1, "dup": 2})",
+        R"([1, 2)",
+        R"({"a" 1})",
+        R"("bad \q escape")",
+        R"(nul)",
+    };
+    for (const std::string& document : documents) {
+        const auto tree = TryLoad([&document]() {
+            return json::Load(document).GetRoot();
+        });
+        const auto flat = TryLoad([&document]() {
+            return json::FlatDocument(document).GetRoot().ToNode();
+        });
+        Check(tree == flat, "flat document matches json::Load: " + document);
+    }
+}
+
+void TestAccess() {
+    const std::string document = R"({"name": "plain", "escaped": "a\"b", "items": [10, 2.5], "nested": {"flag": true}})";
+    const json::FlatDocument flat(document);
+    const json::FlatNode& root = flat.GetRoot();
+
+    const std::string_view name = root.At("name").AsString();
+    Check(name == "plain" && name.data() >= document.data() && name.data() < document.data() + document.size(),
+        "unescaped string is a view into the input");
+    const std::string_view escaped = root.At("escaped").AsString();
+    Check(escaped == "a\"b" && (escaped.data() < document.data() || escaped.data() >= document.data() + document.size()),
+        "unescaped copy lives in the arena");
+
+    Check(root.Size() == 4, "dict size");
+    Check(root.At("items")[0].AsInt() == 10 && root.At("items")[1].AsDouble() == 2.5, "array items");
+    Check(root.At("nested").At("flag").AsBool(), "nested dict");
+    Check(root.Find("missing") == nullptr, "missing key is not found");
+
+    bool thrown = false;
+    try {
+        root.At("items")[2];
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    Check(thrown, "array index is checked");
+}
+
+// Выделения памяти на построение и удаление документа из 100000 словарей
+void TestFewAllocations() {
+    std::string document = "[";
+    for (int i = 0; i < 100000; ++i) {
+        document += R"({"name": "stop)" + std::to_string(i) + R"(", "latitude": 55.6, "road_distances": {"a": 1, "b": 2}},)";
+    }
+    document.back() = ']';
+
+    const size_t before = allocation_count;
+    {
+        const json::FlatDocument flat(document);
+        Check(flat.GetRoot().Size() == 100000, "all items are read");
+    }
+    const size_t flat_allocations = allocation_count - before;
+    std::cout << "FlatDocument: " << flat_allocations << " allocations\n";
+    Check(flat_allocations < 100, "flat document does not allocate per node");
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    ++allocation_count;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+int main() {
+    TestSameAsLoad();
+    TestAccess();
+    TestFewAllocations();
+    if (failed) {
+        return EXIT_FAILURE;
+    }
+    std::cout << "flat json document: OK\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+#include "../json.h"
+#include "../json_binding.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+
+/*
+ * Чтение документа из потока не должно копировать его целиком ещё раз (ostringstream::str() и т.п.).
+ * Глобальные operator new/delete считают живые байты; проверяется пик прироста за время разбора.
+ */
+
+namespace {
+
+size_t live_bytes = 0;
+size_t peak_bytes = 0;
+
+// Перед блоком хранится его размер; выравнивание сохраняется
+constexpr size_t HEADER = alignof(std::max_align_t);
+
+void* Allocate(size_t size) {
+    auto* block = static_cast<unsigned char*>(std::malloc(size + HEADER));
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<size_t*>(block) = size;
+    live_bytes += size;
+    if (live_bytes > peak_bytes) {
+        peak_bytes = live_bytes;
+    }
+    return block + HEADER;
+}
+
+void Deallocate(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    auto* block = static_cast<unsigned char*>(ptr) - HEADER;
+    live_bytes -= *reinterpret_cast<size_t*>(block);
+    std::free(block);
+}
+
+// Прирост пика живых байт за время action относительно размера документа
+template <typename Action>
+double PeakRatio(const std::string& document, Action action) {
+    std::istringstream input(document);
+    const size_t base = live_bytes;
+    peak_bytes = live_bytes;
+    action(input);
+    return static_cast<double>(peak_bytes - base) / static_cast<double>(document.size());
+}
+
+bool Check(const char* name, double ratio, double limit) {
+    std::cout << name << ": peak " << ratio << " x document (limit " << limit << ")\n";
+    if (ratio > limit) {
+        std::cerr << name << ": document is copied while reading the stream\n";
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    return Allocate(size);
+}
+void* operator new[](size_t size) {
+    return Allocate(size);
+}
+void operator delete(void* ptr) noexcept {
+    Deallocate(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+    Deallocate(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept {
+    Deallocate(ptr);
+}
+void operator delete[](void* ptr, size_t) noexcept {
+    Deallocate(ptr);
+}
+
+int main() {
+    constexpr size_t DOCUMENT_SIZE = 8 * 1024 * 1024;
+    //--массив чисел: пропуск значения в Reader сам ничего не выделяет
+    std::string numbers = "[";
+    while (numbers.size() < DOCUMENT_SIZE) {
+        numbers += "12345,";
+    }
+    numbers += "0]";
+    //--одна строка без escape-последовательностей: дерево и структура хранят ровно одну её копию
+    const std::string text = '"' + std::string(DOCUMENT_SIZE, 'x') + '"';
+
+    bool ok = true;
+    ok &= Check("ReadStream", PeakRatio(numbers, [](std::istream& input) {
+        const std::string buffer = json::ReadStream(input);
+        json::Reader reader(buffer);
+        reader.Skip();
+        }), 1.5);
+    ok &= Check("Load", PeakRatio(text, [](std::istream& input) {
+        json::Document document = json::Load(input);
+        }), 2.5);
+    ok &= Check("Decode", PeakRatio(text, [](std::istream& input) {
+        std::string value;
+        json::Decode(input, value);
+        }), 2.5);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
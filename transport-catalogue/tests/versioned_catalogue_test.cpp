@@ -0,0 +1,155 @@
+#include "../request_handler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Версии справочника заменяются, пока читатели держат захваченные через Acquire версии:
+ * захваченная версия остаётся целой, а CollectRetired освобождает её только после того, как читатель её отпустит.
+ */
+
+namespace {
+
+bool failed = false;
+
+void Check(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cerr << "FAILED: " << message << '\n';
+        failed = true;
+    }
+}
+
+// Версия со справочником из одной остановки "v<номер>"; номер версии, который назначит Publish, известен заранее
+std::unique_ptr<handler::CatalogueVersion> MakeVersion(uint64_t expected_number) {
+    auto catalogue = std::make_unique<model::TransportCatalogue>();
+    catalogue->AddStop("v" + std::to_string(expected_number), { 55.6, 37.2 });
+    return handler::BuildCatalogueVersion(std::move(catalogue), std::nullopt, std::nullopt);
+}
+
+bool HasOwnStop(const handler::CatalogueVersion& version) {
+    return version.GetCatalogue().FindStopByName("v" + std::to_string(version.number)) != nullptr;
+}
+
+void TestHeldVersionSurvivesPublish() {
+    handler::VersionedCatalogue versions;
+    versions.Publish(MakeVersion(1));
+
+    auto held = versions.Acquire();
+    std::weak_ptr<const handler::CatalogueVersion> watched = held;
+    Check(versions.Publish(MakeVersion(2)) == 2, "second version gets number 2");
+    Check(versions.Acquire()->number == 2, "readers see the new version after Publish");
+
+    Check(versions.CollectRetired() == 0, "held version is not collected");
+    Check(held->number == 1 && HasOwnStop(*held), "held version stays intact");
+
+    held.reset();
+    Check(versions.CollectRetired() == 1, "released version is collected");
+    Check(watched.expired(), "collected version is destroyed");
+}
+
+void TestConcurrentReaders() {
+    constexpr int reader_count = 4;
+    constexpr uint64_t version_count = 200;
+
+    handler::VersionedCatalogue versions;
+    versions.Publish(MakeVersion(1));
+
+    std::atomic<bool> stop = false;
+    std::atomic<int> errors = 0;
+    std::vector<std::thread> readers;
+    for (int i = 0; i < reader_count; ++i) {
+        readers.emplace_back([&]() {
+            uint64_t last_number = 0;
+            while (!stop.load()) {
+                const auto version = versions.Acquire();
+                //--номера версий у одного читателя не убывают, захваченная версия не меняется
+                if (version->number < last_number || !HasOwnStop(*version)) {
+                    ++errors;
+                }
+                last_number = version->number;
+            }
+        });
+    }
+
+    size_t collected = 0;
+    for (uint64_t number = 2; number <= version_count; ++number) {
+        versions.Publish(MakeVersion(number));
+        collected += versions.CollectRetired();
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    collected += versions.CollectRetired();
+
+    Check(errors == 0, "readers always see a consistent version");
+    Check(collected == version_count - 1, "every retired version is collected once readers are gone");
+    Check(versions.Acquire()->number == version_count, "last published version is current");
+}
+
+// Версия с настройками маршрутизации отвечает на запросы к справочнику, не строя таблицу маршрутов:
+// для 3000 остановок (6000 вершин) она заняла бы сотни мегабайт и минуты расчёта
+void TestRouterIsBuiltOnDemand() {
+    constexpr int stop_count = 3000;
+    auto catalogue = std::make_unique<model::TransportCatalogue>();
+    for (int i = 0; i < stop_count; ++i) {
+        catalogue->AddStop("s" + std::to_string(i), { 55.5 + i * 1e-4, 37.5 });
+    }
+    const routing::RoutingSettings routing_settings{ 6, 40. * 1000. / 60., 0., 0. };
+
+    const auto start = std::chrono::steady_clock::now();
+    handler::VersionedCatalogue versions;
+    versions.Publish(handler::BuildCatalogueVersion(std::move(catalogue), std::nullopt, routing_settings));
+    const auto version = versions.Acquire();
+    Check(version->GetCatalogue().FindStopByName("s2999") != nullptr, "stop requests are answered");
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    Check(elapsed < std::chrono::seconds(10), "publishing a version does not build the route table");
+    Check(version->GetRenderer() == nullptr, "no renderer without render_settings");
+}
+
+// Маршрутизатор строится один раз и общий для всех читателей версии
+void TestRouterIsShared() {
+    auto catalogue = std::make_unique<model::TransportCatalogue>();
+    catalogue->AddStop("a", { 55.6, 37.2 });
+    catalogue->AddStop("b", { 55.61, 37.2 });
+    catalogue->SetStopsDistance("a", "b", 1000.);
+    catalogue->AddBus("1", { "a", "b" }, false);
+    const auto version = handler::BuildCatalogueVersion(std::move(catalogue), std::nullopt,
+        routing::RoutingSettings{ 6, 40. * 1000. / 60., 0., 0. });
+
+    std::vector<const routing::TransportRouter*> routers(4, nullptr);
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < routers.size(); ++i) {
+        readers.emplace_back([&, i]() {
+            routers[i] = version->GetRouter();
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    Check(routers[0] != nullptr, "router is built on first use");
+    for (const auto* router : routers) {
+        Check(router == routers[0], "all readers share one router");
+    }
+    Check(routers[0]->BuildRoute("a", "b").has_value(), "route is found");
+}
+
+}  // namespace
+
+int main() {
+    TestHeldVersionSurvivesPublish();
+    TestConcurrentReaders();
+    TestRouterIsBuiltOnDemand();
+    TestRouterIsShared();
+    if (failed) {
+        return EXIT_FAILURE;
+    }
+    std::cout << "versioned catalogue: OK\n";
+    return EXIT_SUCCESS;
+}
@@ -1,52 +1,498 @@
 #include "transport_catalogue.h"
 
+#include <exception>
+#include <iterator>
+#include <unordered_set>
+#include <thread>
+
+namespace {
+
+    //--первый блок арены справочника, следующие растут геометрически
+    constexpr size_t INITIAL_ARENA_SIZE = 64 * 1024;
+
+    //--меньше этого числа элементов на поток работа выполняется в вызывающем потоке
+    constexpr size_t PARALLEL_GRAIN = 4096;
+
+    size_t GetWorkerCount(size_t item_count) {
+        const size_t hardware = std::max<size_t>(1, std::thread::hardware_concurrency());
+        return std::max<size_t>(1, std::min(hardware, item_count / PARALLEL_GRAIN));
+    }
+
+    // Вызывает func(worker) для каждого номера в [0, worker_count), нулевой — в вызывающем потоке.
+    // Первое исключение из потоков пробрасывается после их завершения
+    template <typename Func>
+    void RunWorkers(size_t worker_count, Func func) {
+        std::vector<std::exception_ptr> errors(worker_count);
+        const auto run = [&](size_t worker) {
+            try {
+                func(worker);
+            }
+            catch (...) {
+                errors[worker] = std::current_exception();
+            }
+        };
+        std::vector<std::thread> workers;
+        workers.reserve(worker_count);
+        for (size_t worker = 1; worker < worker_count; ++worker) {
+            workers.emplace_back(run, worker);
+        }
+        run(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    // Делит диапазон [0, item_count) на равные куски и вызывает func(begin, end) для каждого в своём потоке
+    template <typename Func>
+    void ParallelFor(size_t item_count, Func func) {
+        const size_t worker_count = GetWorkerCount(item_count);
+        RunWorkers(worker_count, [&](size_t worker) {
+            func(item_count * worker / worker_count, item_count * (worker + 1) / worker_count);
+            });
+    }
+
+    // Сортирует куски в отдельных потоках, затем попарно сливает их
+    template <typename T, typename Compare>
+    void ParallelSort(std::vector<T>& items, Compare comp) {
+        const size_t worker_count = GetWorkerCount(items.size());
+        const auto bound = [&](size_t worker) {
+            return items.begin() + items.size() * worker / worker_count;
+        };
+        RunWorkers(worker_count, [&](size_t worker) {
+            std::sort(bound(worker), bound(worker + 1), comp);
+            });
+        for (size_t step = 1; step < worker_count; step *= 2) {
+            for (size_t worker = 0; worker + step < worker_count; worker += 2 * step) {
+                std::inplace_merge(bound(worker), bound(worker + step), bound(std::min(worker + 2 * step, worker_count)), comp);
+            }
+        }
+    }
+
+    int CountBits(uint64_t word) {
+#if defined(__GNUC__)
+        return __builtin_popcountll(word);
+#else
+        int count = 0;
+        for (; word != 0; word &= word - 1) {
+            ++count;
+        }
+        return count;
+#endif
+    }
+
+    // Упорядочивает остановки или автобусы по названию (для справочника без индексов)
+    template <typename T>
+    void SortByName(std::vector<const T*>& items) {
+        std::sort(items.begin(), items.end(), [](const T* lhs, const T* rhs) {
+            return lhs->name < rhs->name;
+            });
+    }
+
+    int LowestBit(uint64_t word) {
+#if defined(__GNUC__)
+        return __builtin_ctzll(word);
+#else
+        int bit = 0;
+        for (; (word & 1) == 0; word >>= 1) {
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+}
+
 namespace model {
 
-    void TransportCatalogue::AddStop(const std::string& stop_name, const geo::Coordinates& coord) {
-        auto stop_ptr = GetStopPtr(stop_name, coord);
-        stop_data_[stop_ptr->name] = stop_ptr;
-        stops_in_task_.insert(stop_ptr->name);
+    TransportCatalogue::TransportCatalogue()
+        : memory_(std::make_unique<Arena>(INITIAL_ARENA_SIZE))
+        , stops_(&memory_->buffer)
+        , buses_(&memory_->buffer)
+        , stop_data_(&memory_->buffer)
+        , bus_data_(&memory_->buffer)
+        , stops_distance_(&memory_->buffer) {
     }
 
-    void TransportCatalogue::SetStopsDistance(const std::string& from, const std::string& to, double distance) {    
-        auto pair_stops = std::make_pair(FindStopByName(from), FindStopByName(to));
-        stops_distance_[pair_stops] = distance;
+    void TransportCatalogue::SetChangeListener(ChangeListener* listener) {
+        listener_ = listener;
     }
 
-    void TransportCatalogue::AddBus(const std::string& bus_name, const std::vector<std::string>& route,
-        const std::vector<std::string>& end_points, bool is_roundtrip, size_t end_point_idx) {
+    void TransportCatalogue::AddStop(std::string_view stop_name, const geo::Coordinates& coord) {
+        if (const auto it = stop_data_.find(stop_name); it != stop_data_.end()) {
+            if (!ReplaceStop(it->second, coord)) {
+                return;
+            }
+        }
+        else {
+            const Stop* stop_ptr = CreateStop(stop_name, coord);
+            stop_data_.emplace(stop_ptr->name, stop_ptr);
+        }
+        if (listener_) {
+            listener_->OnAddStop(stop_name, coord);
+        }
+    }
 
-        std::vector<std::string_view> copy_route(route.size());
-        std::transform(route.begin(), route.end(), copy_route.begin(), [&](std::string_view s) {
+    void TransportCatalogue::SetStopsDistance(std::string_view from, std::string_view to, double distance) {    
+        if (!StoreStopsDistance({ FindStopByName(from), FindStopByName(to) }, distance)) {
+            return;
+        }
+        if (listener_) {
+            listener_->OnSetStopsDistance(from, to, distance);
+        }
+    }
+
+    void TransportCatalogue::AddBus(std::string_view bus_name, const std::vector<std::string_view>& stops, bool is_roundtrip) {
+        std::vector<std::string_view> copy_stops(stops.size());
+        std::transform(stops.begin(), stops.end(), copy_stops.begin(), [&](std::string_view s) {
             return GetCopyStopName(s);
             });
-        std::vector<std::string_view> copy_end_points(end_points.size());
-        std::transform(end_points.begin(), end_points.end(), copy_end_points.begin(), [&](std::string_view s) {
-            return GetCopyStopName(s);
+        if (const auto it = bus_data_.find(bus_name); it != bus_data_.end()) {
+            if (!ReplaceBus(it->second, copy_stops, is_roundtrip)) {
+                return;
+            }
+        }
+        else {
+            const Bus* bus_ptr = CreateBus(bus_name, copy_stops, is_roundtrip);
+            bus_data_.emplace(bus_ptr->name, bus_ptr);
+        }
+        if (listener_) {
+            listener_->OnAddBus(bus_name, stops, is_roundtrip);
+        }
+    }
+
+    void TransportCatalogue::LoadImage(const CatalogueImage& image) {
+        if (!stops_.empty() || !buses_.empty() || names_.Size() != 0) {
+            throw std::logic_error("LoadImage: catalogue is not empty");
+        }
+        if (!image.name_pool.empty()) {
+            names_.Adopt(image.name_pool, image.name_pool_owner);
+        }
+
+        stop_coords_.Reserve(image.stop_count);
+        stop_data_.reserve(image.stop_count);
+        for (size_t id = 0; id < image.stop_count; ++id) {
+            const geo::Coordinates coord{ image.stop_lats[id], image.stop_lngs[id] };
+            stop_coords_.Add(coord);
+            const Stop& stop = stops_.emplace_back(id, names_.Resolve(image.stop_names[id]), coord);
+            stop_data_.emplace(stop.name, &stop);
+        }
+
+        const size_t distance_count = image.stop_count == 0 ? 0 : image.distance_offsets[image.stop_count];
+        stops_distance_.reserve(distance_count);
+        for (size_t from = 0; from < image.stop_count; ++from) {
+            for (uint32_t pos = image.distance_offsets[from]; pos < image.distance_offsets[from + 1]; ++pos) {
+                stops_distance_.emplace(std::pair{ &stops_[from], &stops_[image.distance_to[pos]] }, image.distance_values[pos]);
+            }
+        }
+
+        bus_data_.reserve(image.bus_count);
+        for (size_t id = 0; id < image.bus_count; ++id) {
+            Bus& bus = buses_.emplace_back(id, names_.Resolve(image.bus_names[id]), image.roundtrip[id] != 0, &memory_->buffer);
+            const uint32_t* first = image.route_stops + image.route_offsets[id];
+            const uint32_t* last = image.route_stops + image.route_offsets[id + 1];
+            bus.stops.reserve(last - first);
+            std::transform(first, last, std::back_inserter(bus.stops), [this](uint32_t stop_id) {
+                return stops_[stop_id].name;
+                });
+            bus_data_.emplace(bus.name, &bus);
+        }
+    }
+
+    void TransportCatalogue::BulkLoad(const BaseRequestBatch& batch) {
+        //--индексы сбрасываются только при появлении или изменении остановок и автобусов (Create*/Replace*)
+        //--остановки: названия копируются в арену последовательно, первое описание с данным названием побеждает,
+        //--остановки из прежних пакетов получают новые координаты. Уведомления — только о действующих описаниях
+        std::vector<bool> stop_changed(batch.stops.size(), false);
+        std::unordered_set<std::string_view> batch_names;
+        batch_names.reserve(batch.stops.size());
+        stop_data_.reserve(stop_data_.size() + batch.stops.size());
+        for (size_t i = 0; i < batch.stops.size(); ++i) {
+            const StopDescription& stop = batch.stops[i];
+            if (!batch_names.insert(stop.name).second) {
+                continue;
+            }
+            if (const auto it = stop_data_.find(stop.name); it != stop_data_.end()) {
+                stop_changed[i] = ReplaceStop(it->second, stop.coord);
+            }
+            else {
+                const Stop* stop_ptr = CreateStop(stop.name, stop.coord);
+                stop_data_.emplace(stop_ptr->name, stop_ptr);
+                stop_changed[i] = true;
+            }
+        }
+
+        //--расстояния: названия разрешаются параллельно, вставка идёт в исходном порядке (последнее значение побеждает)
+        std::vector<size_t> distance_offsets(batch.stops.size() + 1, 0);
+        for (size_t i = 0; i < batch.stops.size(); ++i) {
+            distance_offsets[i + 1] = distance_offsets[i] + batch.stops[i].road_distances.size();
+        }
+        std::vector<std::pair<const Stop*, const Stop*>> distance_keys(distance_offsets.back());
+        ParallelFor(batch.stops.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const Stop* from = ResolveStop(batch.stops[i].name);
+                size_t pos = distance_offsets[i];
+                for (const auto& [to_name, distance] : batch.stops[i].road_distances) {
+                    distance_keys[pos++] = { from, ResolveStop(to_name) };
+                }
+            }
+            });
+        std::vector<bool> distance_changed(distance_keys.size(), false);
+        stops_distance_.reserve(stops_distance_.size() + distance_keys.size());
+        for (size_t i = 0; i < batch.stops.size(); ++i) {
+            size_t pos = distance_offsets[i];
+            for (const auto& [to_name, distance] : batch.stops[i].road_distances) {
+                distance_changed[pos] = StoreStopsDistance(distance_keys[pos], distance);
+                ++pos;
+            }
+        }
+
+        //--автобусы: остановки разрешаются параллельно
+        std::vector<size_t> route_offsets(batch.buses.size() + 1, 0);
+        for (size_t i = 0; i < batch.buses.size(); ++i) {
+            route_offsets[i + 1] = route_offsets[i] + batch.buses[i].stops.size();
+        }
+        std::vector<std::string_view> route_stops(route_offsets.back());
+        ParallelFor(batch.buses.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                size_t pos = route_offsets[i];
+                for (std::string_view stop_name : batch.buses[i].stops) {
+                    route_stops[pos++] = ResolveStop(stop_name)->name;
+                }
+            }
+            });
+        std::vector<bool> bus_changed(batch.buses.size(), false);
+        batch_names.clear();
+        bus_data_.reserve(bus_data_.size() + batch.buses.size());
+        for (size_t i = 0; i < batch.buses.size(); ++i) {
+            const BusDescription& bus = batch.buses[i];
+            if (!batch_names.insert(bus.name).second) {
+                continue;
+            }
+            const std::vector<std::string_view> stops(route_stops.begin() + route_offsets[i], route_stops.begin() + route_offsets[i + 1]);
+            if (const auto it = bus_data_.find(bus.name); it != bus_data_.end()) {
+                bus_changed[i] = ReplaceBus(it->second, stops, bus.is_roundtrip);
+            }
+            else {
+                const Bus* bus_ptr = CreateBus(bus.name, stops, bus.is_roundtrip);
+                bus_data_.emplace(bus_ptr->name, bus_ptr);
+                bus_changed[i] = true;
+            }
+        }
+
+        if (listener_) {
+            for (size_t i = 0; i < batch.stops.size(); ++i) {
+                if (stop_changed[i]) {
+                    listener_->OnAddStop(batch.stops[i].name, batch.stops[i].coord);
+                }
+            }
+            for (size_t i = 0; i < batch.stops.size(); ++i) {
+                size_t pos = distance_offsets[i];
+                for (const auto& [to_name, distance] : batch.stops[i].road_distances) {
+                    if (distance_changed[pos++]) {
+                        listener_->OnSetStopsDistance(batch.stops[i].name, to_name, distance);
+                    }
+                }
+            }
+            for (size_t i = 0; i < batch.buses.size(); ++i) {
+                if (bus_changed[i]) {
+                    listener_->OnAddBus(batch.buses[i].name, batch.buses[i].stops, batch.buses[i].is_roundtrip);
+                }
+            }
+        }
+    }
+
+    void TransportCatalogue::Freeze() {
+        if (frozen_) {
+            return;
+        }
+        stop_index_.Build(stop_data_.begin(), stop_data_.end());
+        bus_index_.Build(bus_data_.begin(), bus_data_.end());
+        stop_grid_ = geo::GridIndex(stop_coords_);
+        BuildStopBusIndex();
+        BuildNameDictionaries();
+        frozen_ = true;
+    }
+
+    bool TransportCatalogue::IsFrozen() const {
+        return frozen_;
+    }
+
+    void TransportCatalogue::Unfreeze() {
+        if (!frozen_) {
+            return;
+        }
+        stop_index_.Clear();
+        bus_index_.Clear();
+        stop_grid_ = geo::GridIndex();
+        stop_bus_words_ = 0;
+        stop_bus_bits_.clear();
+        route_offsets_.clear();
+        route_stop_ids_.clear();
+        stop_names_.Clear();
+        bus_names_.Clear();
+        stop_by_rank_.clear();
+        bus_by_rank_.clear();
+        bus_rank_.clear();
+        stop_bus_counts_.Clear();
+        frozen_ = false;
+    }
+
+    void TransportCatalogue::BuildStopBusIndex() {
+        stop_bus_words_ = (buses_.size() + 63) / 64;
+        stop_bus_bits_.assign(stop_bus_words_ * stops_.size(), 0);
+        route_offsets_.assign(1, 0);
+        route_stop_ids_.clear();
+        for (const Bus& bus : buses_) {
+            for (std::string_view stop_name : bus.stops) {
+                StopId stop_id = stop_data_.at(stop_name)->id;
+                route_stop_ids_.push_back(stop_id);
+                stop_bus_bits_[stop_id * stop_bus_words_ + bus.id / 64] |= uint64_t{ 1 } << (bus.id % 64);
+            }
+            route_offsets_.push_back(route_stop_ids_.size());
+        }
+    }
+
+    void TransportCatalogue::BuildNameDictionaries() {
+        stop_by_rank_.resize(stops_.size());
+        std::iota(stop_by_rank_.begin(), stop_by_rank_.end(), StopId{ 0 });
+        ParallelSort(stop_by_rank_, [this](StopId lhs, StopId rhs) {
+            return stops_[lhs].name < stops_[rhs].name;
             });
-        auto bus_ptr = GetBusPtr(bus_name, copy_route, copy_end_points, is_roundtrip, end_point_idx);
-        bus_data_[bus_ptr->name] = bus_ptr;
-        //--
-        for (std::string_view stop_name : copy_route) {
-            stop_buses_[stop_name].insert(GetCopyBusName(bus_name));
-            stops_in_routes_.insert(stop_name);
+        std::vector<std::string_view> names(stop_by_rank_.size());
+        std::transform(stop_by_rank_.begin(), stop_by_rank_.end(), names.begin(), [this](StopId id) {
+            return stops_[id].name;
+            });
+        stop_names_.Build(names.begin(), names.end());
+
+        bus_by_rank_.resize(buses_.size());
+        std::iota(bus_by_rank_.begin(), bus_by_rank_.end(), BusId{ 0 });
+        ParallelSort(bus_by_rank_, [this](BusId lhs, BusId rhs) {
+            return buses_[lhs].name < buses_[rhs].name;
+            });
+        names.resize(bus_by_rank_.size());
+        std::transform(bus_by_rank_.begin(), bus_by_rank_.end(), names.begin(), [this](BusId id) {
+            return buses_[id].name;
+            });
+        bus_names_.Build(names.begin(), names.end());
+        bus_rank_.resize(buses_.size());
+        for (size_t rank = 0; rank < bus_by_rank_.size(); ++rank) {
+            bus_rank_[bus_by_rank_[rank]] = rank;
         }
+
+        std::vector<uint32_t> bus_counts(stop_by_rank_.size());
+        for (size_t rank = 0; rank < stop_by_rank_.size(); ++rank) {
+            const uint64_t* bits = GetStopBusBits(stop_by_rank_[rank]);
+            for (size_t w = 0; w < stop_bus_words_; ++w) {
+                bus_counts[rank] += CountBits(bits[w]);
+            }
+        }
+        stop_bus_counts_.Build(std::move(bus_counts));
+    }
+
+    const uint64_t* TransportCatalogue::GetStopBusBits(StopId id) const {
+        return stop_bus_bits_.data() + id * stop_bus_words_;
+    }
+
+    std::optional<std::vector<const Bus*>> TransportCatalogue::GetDirectBuses(std::string_view from, std::string_view to) const {
+        const Stop* stop_from = FindStopByName(from);
+        const Stop* stop_to = FindStopByName(to);
+        if (!stop_from || !stop_to) {
+            return std::nullopt;
+        }
+        std::vector<const Bus*> result;
+        if (stop_from == stop_to) {
+            return result;
+        }
+        if (!frozen_) {
+            for (const Bus& bus : buses_) {
+                const auto first_from = std::find(bus.stops.begin(), bus.stops.end(), stop_from->name);
+                if (first_from == bus.stops.end()) {
+                    continue;
+                }
+                const auto to_begin = bus.is_roundtrip ? first_from : bus.stops.begin();
+                if (std::find(to_begin, bus.stops.end(), stop_to->name) != bus.stops.end()) {
+                    result.push_back(&bus);
+                }
+            }
+            SortByName(result);
+            return result;
+        }
+        const uint64_t* bits_from = GetStopBusBits(stop_from->id);
+        const uint64_t* bits_to = GetStopBusBits(stop_to->id);
+        size_t candidates = 0;
+        for (size_t w = 0; w < stop_bus_words_; ++w) {
+            candidates += CountBits(bits_from[w] & bits_to[w]);
+        }
+        result.reserve(candidates);
+        for (size_t w = 0; w < stop_bus_words_; ++w) {
+            for (uint64_t common = bits_from[w] & bits_to[w]; common != 0; common &= common - 1) {
+                const BusId bus_id = w * 64 + LowestBit(common);
+                //--некольцевой автобус идёт в обе стороны, кольцевой подходит, если from встречается раньше to
+                const Bus& bus = buses_[bus_id];
+                const auto route_begin = route_stop_ids_.begin() + route_offsets_[bus_id];
+                const auto route_end = route_stop_ids_.begin() + route_offsets_[bus_id + 1];
+                const auto first_from = std::find(route_begin, route_end, stop_from->id);
+                if (!bus.is_roundtrip || std::find(first_from, route_end, stop_to->id) != route_end) {
+                    result.push_back(&bus);
+                }
+            }
+        }
+        std::sort(result.begin(), result.end(), [this](const Bus* lhs, const Bus* rhs) {
+            return bus_rank_[lhs->id] < bus_rank_[rhs->id];
+            });
+        return result;
     }
 
     const Bus* TransportCatalogue::FindBusByName(std::string_view bus_name) const {
-        if (bus_data_.count(bus_name)) {
-            return bus_data_.at(bus_name);
+        if (frozen_) {
+            return bus_index_.Find(bus_name);
+        }
+        if (const auto it = bus_data_.find(bus_name); it != bus_data_.end()) {
+            return it->second;
         }
         return nullptr;
     }
 
     const Stop* TransportCatalogue::FindStopByName(std::string_view stop_name) const {
-        if (stop_data_.count(stop_name)) {
-            return stop_data_.at(stop_name);
+        if (frozen_) {
+            return stop_index_.Find(stop_name);
+        }
+        if (const auto it = stop_data_.find(stop_name); it != stop_data_.end()) {
+            return it->second;
         }
         return nullptr;
     }
 
+    const Stop* TransportCatalogue::GetStopById(StopId id) const {
+        return id < stops_.size() ? &stops_[id] : nullptr;
+    }
+
+    const geo::CoordinatesTable& TransportCatalogue::GetStopCoordinates() const {
+        return stop_coords_;
+    }
+
+    std::vector<NearbyStop> TransportCatalogue::FindNearbyStops(geo::Coordinates center, double radius, size_t count) const {
+        //--без заморозки сетка строится на время запроса
+        const geo::GridIndex grid = frozen_ ? geo::GridIndex() : geo::GridIndex(stop_coords_);
+        std::vector<NearbyStop> result;
+        for (const auto& [id, distance] : (frozen_ ? stop_grid_ : grid).FindNearby(center, radius, count)) {
+            result.push_back({ &stops_[id], distance });
+        }
+        return result;
+    }
+
+    const geo::GridIndex& TransportCatalogue::GetStopGrid() const {
+        if (!frozen_) {
+            throw std::logic_error("GetStopGrid: catalogue is not frozen");
+        }
+        return stop_grid_;
+    }
+
     double TransportCatalogue::GetStopsDistance(std::string_view from, std::string_view to) const
     {
         auto pair_stops_from = std::make_pair(FindStopByName(from), FindStopByName(to));
@@ -63,37 +509,174 @@ namespace model {
         }
     }
 
-    std::optional<std::set<std::string_view>> TransportCatalogue::GetBusesByStop(std::string_view stop_name) const {
-        if (stop_data_.size() != stop_buses_.size()) {
-            for (const auto& [name, data] : stop_data_) {
-                stop_buses_[name];
+    std::vector<StopSuggestion> TransportCatalogue::SuggestStops(std::string_view prefix, size_t count, bool by_bus_count) const {
+        if (!frozen_) {
+            std::vector<size_t> bus_counts(stops_.size(), 0);
+            for (const Bus& bus : buses_) {
+                std::vector<bool> seen(stops_.size(), false);
+                for (std::string_view stop_name : bus.stops) {
+                    const StopId id = stop_data_.at(stop_name)->id;
+                    if (!seen[id]) {
+                        seen[id] = true;
+                        ++bus_counts[id];
+                    }
+                }
+            }
+            std::vector<StopSuggestion> result;
+            for (const Stop* stop : GetSortedStops()) {
+                if (stop->name.substr(0, prefix.size()) == prefix) {
+                    result.push_back({ stop, bus_counts[stop->id] });
+                }
             }
+            if (by_bus_count) {
+                std::stable_sort(result.begin(), result.end(), [](const StopSuggestion& lhs, const StopSuggestion& rhs) {
+                    return lhs.bus_count > rhs.bus_count;
+                    });
+            }
+            result.resize(std::min(result.size(), count));
+            return result;
         }
-        if (stop_buses_.count(stop_name)) {
-            return stop_buses_.at(stop_name);
+        const auto [first, last] = stop_names_.PrefixRange(prefix);
+        std::vector<size_t> ranks;
+        if (by_bus_count) {
+            ranks = stop_bus_counts_.TopK(first, last, count);
         }
-        return std::nullopt;
+        else {
+            for (size_t rank = first; rank < last && ranks.size() < count; ++rank) {
+                ranks.push_back(rank);
+            }
+        }
+        std::vector<StopSuggestion> result;
+        result.reserve(ranks.size());
+        for (size_t rank : ranks) {
+            result.push_back({ &stops_[stop_by_rank_[rank]], stop_bus_counts_.Get(rank) });
+        }
+        return result;
     }
 
-    std::optional<RouteInfo> TransportCatalogue::GetRouteInfoByBusName(const std::string& name) const {
+    const Stop* TransportCatalogue::GetStopByRank(size_t rank) const {
+        return rank < stop_by_rank_.size() ? &stops_[stop_by_rank_[rank]] : nullptr;
+    }
 
-        if (bus_data_.count(name)) {
-            auto bus = bus_data_.at(name);
-            auto route = bus->route;
+    const Bus* TransportCatalogue::GetBusByRank(size_t rank) const {
+        return rank < bus_by_rank_.size() ? &buses_[bus_by_rank_[rank]] : nullptr;
+    }
+
+    std::vector<const Stop*> TransportCatalogue::GetSortedStops() const {
+        std::vector<const Stop*> result;
+        if (!frozen_) {
+            //--без индексов сортировка выполняется на месте, как прежде через std::set
+            result.reserve(stops_.size());
+            for (const Stop& stop : stops_) {
+                result.push_back(&stop);
+            }
+            SortByName(result);
+            return result;
+        }
+        result.reserve(stop_by_rank_.size());
+        for (StopId id : stop_by_rank_) {
+            result.push_back(&stops_[id]);
+        }
+        return result;
+    }
+
+    std::vector<const Stop*> TransportCatalogue::GetSortedStopsInRoutes() const {
+        std::vector<const Stop*> result;
+        if (!frozen_) {
+            std::vector<bool> in_routes(stops_.size(), false);
+            for (const Bus& bus : buses_) {
+                for (std::string_view stop_name : bus.stops) {
+                    in_routes[stop_data_.at(stop_name)->id] = true;
+                }
+            }
+            for (const Stop& stop : stops_) {
+                if (in_routes[stop.id]) {
+                    result.push_back(&stop);
+                }
+            }
+            SortByName(result);
+            return result;
+        }
+        for (StopId id : stop_by_rank_) {
+            const uint64_t* bits = GetStopBusBits(id);
+            if (std::any_of(bits, bits + stop_bus_words_, [](uint64_t word) { return word != 0; })) {
+                result.push_back(&stops_[id]);
+            }
+        }
+        return result;
+    }
+
+    std::vector<const Bus*> TransportCatalogue::GetSortedBuses() const {
+        std::vector<const Bus*> result;
+        if (!frozen_) {
+            result.reserve(buses_.size());
+            for (const Bus& bus : buses_) {
+                result.push_back(&bus);
+            }
+            SortByName(result);
+            return result;
+        }
+        result.reserve(bus_by_rank_.size());
+        for (BusId id : bus_by_rank_) {
+            result.push_back(&buses_[id]);
+        }
+        return result;
+    }
+
+    std::optional<std::vector<std::string_view>> TransportCatalogue::GetBusesByStop(std::string_view stop_name) const {
+        const Stop* stop = FindStopByName(stop_name);
+        if (!stop) {
+            return std::nullopt;
+        }
+        if (!frozen_) {
+            std::vector<const Bus*> buses;
+            for (const Bus& bus : buses_) {
+                if (std::find(bus.stops.begin(), bus.stops.end(), stop->name) != bus.stops.end()) {
+                    buses.push_back(&bus);
+                }
+            }
+            SortByName(buses);
+            std::vector<std::string_view> result;
+            result.reserve(buses.size());
+            for (const Bus* bus : buses) {
+                result.push_back(bus->name);
+            }
+            return result;
+        }
+        const uint64_t* bits = GetStopBusBits(stop->id);
+        std::vector<size_t> ranks;
+        for (size_t w = 0; w < stop_bus_words_; ++w) {
+            for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                ranks.push_back(bus_rank_[w * 64 + LowestBit(word)]);
+            }
+        }
+        std::sort(ranks.begin(), ranks.end());
+        std::vector<std::string_view> result;
+        result.reserve(ranks.size());
+        for (size_t rank : ranks) {
+            result.push_back(buses_[bus_by_rank_[rank]].name);
+        }
+        return result;
+    }
+
+    std::optional<RouteInfo> TransportCatalogue::GetRouteInfoByBusName(std::string_view name) const {
+
+        if (auto bus = FindBusByName(name)) {
+            const RouteView route = bus->Route();
 
-            double geographic_length = 0.0;
             double road_length = 0.0;
             size_t route_size = route.size();
+            std::vector<std::pair<StopId, StopId>> segments;
+            segments.reserve(route_size);
             for (size_t i = 0; i + 1 < route_size; i++) {
-                geo::Coordinates from = FindStopByName(route[i])->coord;
-                geo::Coordinates to = FindStopByName(route[i + 1])->coord;
-                double geographic_dist = geo::ComputeDistance(from, to);
-                geographic_length += geographic_dist;
+                segments.emplace_back(FindStopByName(route[i])->id, FindStopByName(route[i + 1])->id);
                 double road_dist = GetStopsDistance(route[i], route[i + 1]);
                 road_length += road_dist;
             }
+            const auto geographic_dists = stop_coords_.ComputeDistances(segments);
+            double geographic_length = std::accumulate(geographic_dists.begin(), geographic_dists.end(), 0.0);
 
-            std::set<std::string_view> unique_stop(route.begin(), route.end());
+            std::set<std::string_view> unique_stop(bus->stops.begin(), bus->stops.end());
             RouteInfo info;
             info.route_name = bus->name;
             info.stop_count = route_size;
@@ -106,29 +689,32 @@ namespace model {
         return std::nullopt;
     }
 
-    const std::deque<Bus>& TransportCatalogue::GetBuses() const {
+    const std::pmr::deque<Bus>& TransportCatalogue::GetBuses() const {
         return buses_;
     }
 
-    const std::unordered_map<std::string_view, const Bus*>& TransportCatalogue::GetBusData() const {
-        return bus_data_;
+    const std::pmr::deque<Stop>& TransportCatalogue::GetStops() const {
+        return stops_;
+    }
+
+    const std::pmr::unordered_map<std::pair<const Stop*, const Stop*>, double, StopHasher>& TransportCatalogue::GetStopsDistances() const {
+        return stops_distance_;
     }
 
-    std::set<std::string_view> TransportCatalogue::GetSortedStopsInRoutes() const {
-        return stops_in_routes_;
+    const StringArena& TransportCatalogue::GetNames() const {
+        return names_;
     }
 
-    std::set<std::string_view> TransportCatalogue::GetSortedStopsInTask() const {    
-        return stops_in_task_;
+    const std::pmr::unordered_map<std::string_view, const Bus*>& TransportCatalogue::GetBusData() const {
+        return bus_data_;
     }
 
     std::vector<TimeAndSpanCount> TransportCatalogue::GetRouteTimeAndSpan(std::string_view bus_name, double bus_velocity) const {
         std::vector<TimeAndSpanCount> dist_time_span;
 
         auto bus = bus_data_.at(bus_name);
-        auto route = bus->route;
-        std::vector<std::string_view> end_points = bus->end_points;        
-        size_t route_size = bus->is_roundtrip ? route.size() : bus->end_point_idx + 1;
+        const auto& route = bus->stops;
+        size_t route_size = route.size();
 
         for (size_t i = 0; i + 1 < route_size; i++) {       //from
 		double road_time = 0.;
@@ -150,16 +736,66 @@ namespace model {
         return dist_time_span;
     }
 
-    /*const std::unordered_map<std::string_view, std::set<std::string_view>>& TransportCatalogue::GetStopPerBuses() const {
-        return stop_buses_;
-    }*/
+    MemoryReport TransportCatalogue::GetMemoryReport() const {
+        MemoryReport report;
+        report.arena_bytes = memory_->upstream.GetAllocatedBytes();
+        report.Add("names", stops_.size() + buses_.size(), names_.GetMemoryUsage());
+        report.Add("stops", stops_.size(), stops_.size() * sizeof(Stop));
+        report.Add("stop_coordinates", stop_coords_.Size(), stop_coords_.GetMemoryUsage());
+        size_t bus_bytes = buses_.size() * sizeof(Bus);
+        for (const Bus& bus : buses_) {
+            bus_bytes += VectorBytes(bus.stops);
+        }
+        report.Add("buses", buses_.size(), bus_bytes);
+        report.Add("stop_data", stop_data_.size(), HashTableBytes(stop_data_));
+        report.Add("bus_data", bus_data_.size(), HashTableBytes(bus_data_));
+        report.Add("stops_distance", stops_distance_.size(), HashTableBytes(stops_distance_));
+        if (frozen_) {
+            report.Add("stop_name_index", stop_index_.Size(), stop_index_.GetMemoryUsage());
+            report.Add("bus_name_index", bus_index_.Size(), bus_index_.GetMemoryUsage());
+            report.Add("stop_grid", stop_grid_.Size(), stop_grid_.GetMemoryUsage());
+            report.Add("stop_bus_bits", stop_bus_bits_.size(), VectorBytes(stop_bus_bits_));
+            report.Add("route_stop_ids", route_stop_ids_.size(), VectorBytes(route_offsets_) + VectorBytes(route_stop_ids_));
+            report.Add("stop_name_dictionary", stop_names_.Size(), stop_names_.GetMemoryUsage() + VectorBytes(stop_by_rank_));
+            report.Add("stop_bus_counts", stop_bus_counts_.Size(), stop_bus_counts_.GetMemoryUsage());
+            report.Add("bus_name_dictionary", bus_names_.Size(),
+                bus_names_.GetMemoryUsage() + VectorBytes(bus_by_rank_) + VectorBytes(bus_rank_));
+        }
+        return report;
+    }
 
-    const Stop* TransportCatalogue::GetStopPtr(const std::string& name, const geo::Coordinates& coord)
-    {
+    const Stop* TransportCatalogue::ResolveStop(std::string_view name) const {
         if (const auto it = stop_data_.find(name); it != stop_data_.end()) {
             return it->second;
         }
-        return &stops_.emplace_back(name, coord);
+        throw std::logic_error("BulkLoad: unknown stop " + std::string(name));
+    }
+
+    const Stop* TransportCatalogue::CreateStop(std::string_view name, const geo::Coordinates& coord)
+    {
+        Unfreeze();
+        StopId id = stop_coords_.Add(coord);
+        return &stops_.emplace_back(id, names_.Append(name), coord);
+    }
+
+    bool TransportCatalogue::ReplaceStop(const Stop* stop, const geo::Coordinates& coord) {
+        if (stop->coord == coord) {
+            return false;
+        }
+        Unfreeze();
+        stops_[stop->id].coord = coord;
+        stop_coords_.Set(stop->id, coord);
+        return true;
+    }
+
+    bool TransportCatalogue::StoreStopsDistance(std::pair<const Stop*, const Stop*> stops, double distance) {
+        const auto [it, inserted] = stops_distance_.try_emplace(stops, distance);
+        if (!inserted && it->second == distance) {
+            return false;
+        }
+        //--индексы замороженного справочника от расстояний не зависят, заморозка сохраняется
+        it->second = distance;
+        return true;
     }
 
     std::string_view TransportCatalogue::GetCopyStopName(std::string_view name) {
@@ -169,19 +805,21 @@ namespace model {
         throw std::logic_error("GetCopyStopName: stop_data not contain stop name");
     }
 
-    const Bus* TransportCatalogue::GetBusPtr(const std::string& name, const std::vector<std::string_view>& route,
-        const std::vector<std::string_view>& end_points, bool is_roundtrip, size_t end_point_idx)
+    const Bus* TransportCatalogue::CreateBus(std::string_view name, const std::vector<std::string_view>& stops, bool is_roundtrip)
     {
-        if (const auto it = bus_data_.find(name); it != bus_data_.end()) {
-            return it->second;
-        }
-        return &buses_.emplace_back(name, route, end_points, is_roundtrip, end_point_idx);
+        Unfreeze();
+        return &buses_.emplace_back(buses_.size(), names_.Append(name), stops, is_roundtrip, &memory_->buffer);
     }
 
-    std::string_view TransportCatalogue::GetCopyBusName(std::string_view name) {
-        if (const auto it = bus_data_.find(name); it != bus_data_.end()) {
-            return it->first;
+    bool TransportCatalogue::ReplaceBus(const Bus* bus, const std::vector<std::string_view>& stops, bool is_roundtrip) {
+        if (std::equal(bus->stops.begin(), bus->stops.end(), stops.begin(), stops.end()) && bus->is_roundtrip == is_roundtrip) {
+            return false;
         }
-        throw std::logic_error("GetCopyBusName: bus_data not contain bus name");
+        Unfreeze();
+        //--прежний буфер остановок переиспользуется, если его ёмкости хватает
+        Bus& target = buses_[bus->id];
+        target.stops.assign(stops.begin(), stops.end());
+        target.is_roundtrip = is_roundtrip;
+        return true;
     }
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <algorithm>
+#include <numeric>
 #include <deque>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
 #include <optional>
 #include <vector>
 #include <utility>
@@ -10,6 +13,12 @@
 #include <set>
 #include "geo.h"
 #include "domain.h"
+#include "string_arena.h"
+#include "perfect_hash.h"
+#include "spatial_index.h"
+#include "memory_report.h"
+#include "front_coded_dictionary.h"
+#include "range_max_index.h"
 
 namespace model {
 
@@ -23,44 +32,204 @@ namespace model {
         int span_count = 0;
     };    
 
+    struct NearbyStop {
+        const Stop* stop = nullptr;
+        double distance = 0.;   // м
+    };
+
+    struct StopSuggestion {
+        const Stop* stop = nullptr;
+        size_t bus_count = 0;
+    };
+
+    // Остановка из пакета базовых запросов. Строки должны жить до конца BulkLoad
+    struct StopDescription {
+        std::string_view name;
+        geo::Coordinates coord;
+        std::vector<std::pair<std::string_view, double>> road_distances;
+    };
+
+    // Автобус из пакета базовых запросов; stops — в прямом направлении
+    struct BusDescription {
+        std::string_view name;
+        std::vector<std::string_view> stops;
+        bool is_roundtrip = false;
+    };
+
+    struct BaseRequestBatch {
+        std::vector<StopDescription> stops;
+        std::vector<BusDescription> buses;
+    };
+
+    // Справочник в виде массивов, индексированных StopId и BusId (формат снимка, см. catalogue_snapshot).
+    // Названия — ссылки в name_pool; расстояния и остановки маршрутов — в формате CSR.
+    // Массивы должны жить до конца LoadImage, name_pool — пока его держит name_pool_owner
+    struct CatalogueImage {
+        std::string_view name_pool;
+        std::shared_ptr<const void> name_pool_owner;
+        //--остановки
+        size_t stop_count = 0;
+        const StringArena::Ref* stop_names = nullptr;
+        const double* stop_lats = nullptr;
+        const double* stop_lngs = nullptr;
+        //--расстояния от остановки i: distance_to/distance_values[distance_offsets[i] .. distance_offsets[i + 1])
+        const uint32_t* distance_offsets = nullptr;
+        const uint32_t* distance_to = nullptr;
+        const double* distance_values = nullptr;
+        //--автобусы, остановки в прямом направлении: route_stops[route_offsets[i] .. route_offsets[i + 1])
+        size_t bus_count = 0;
+        const StringArena::Ref* bus_names = nullptr;
+        const uint32_t* route_offsets = nullptr;
+        const uint32_t* route_stops = nullptr;
+        const uint8_t* roundtrip = nullptr;
+    };
+
+    /**
+     * Получает уведомления об успешных изменениях справочника (например, журнал изменений).
+     */
+    class ChangeListener {
+    public:
+        virtual void OnAddStop(std::string_view stop_name, const geo::Coordinates& coord) = 0;
+        virtual void OnSetStopsDistance(std::string_view from, std::string_view to, double distance) = 0;
+        virtual void OnAddBus(std::string_view bus_name, const std::vector<std::string_view>& stops, bool is_roundtrip) = 0;
+    protected:
+        ~ChangeListener() = default;
+    };
+
+    /**
+     * Все контейнеры справочника размещаются в собственной монотонной арене, которая освобождается
+     * целиком вместе со справочником. Освобождение отдельных элементов арене не передаётся.
+     */
     class TransportCatalogue {
     public:
-        TransportCatalogue() = default;
+        TransportCatalogue();
+        TransportCatalogue(const TransportCatalogue&) = delete;
+        TransportCatalogue& operator=(const TransportCatalogue&) = delete;
+        TransportCatalogue(TransportCatalogue&&) = default;
+        //--контейнеры не передают арену при присваивании, поэтому справочник только перемещаемый
+        TransportCatalogue& operator=(TransportCatalogue&&) = delete;
+
+        // Подключает (или отключает при nullptr) получателя уведомлений об изменениях
+        void SetChangeListener(ChangeListener* listener);
 
-        void AddStop(const std::string& stop_name, const geo::Coordinates& coord);
-        void SetStopsDistance(const std::string& from, const std::string& to, double distance);
-        void AddBus(const std::string& bus_name, const std::vector<std::string>& route,
-            const std::vector<std::string>& end_points, bool is_roundtrip, size_t end_point_idx);
+        //--повторное описание остановки, расстояния или автобуса заменяет прежнее;
+        //--описание, которое ничего не меняет, не передаётся получателю уведомлений
+        void AddStop(std::string_view stop_name, const geo::Coordinates& coord);
+        void SetStopsDistance(std::string_view from, std::string_view to, double distance);
+        // stops — остановки в прямом направлении; обратный путь некольцевого маршрута не передаётся
+        void AddBus(std::string_view bus_name, const std::vector<std::string_view>& stops, bool is_roundtrip);
+        // Загружает пакет целиком: результат тот же, что у последовательных AddStop, SetStopsDistance и AddBus,
+        // но контейнеры размечаются заранее, а разрешение названий и группировка выполняются в нескольких потоках.
+        // Внутри пакета действует первое описание остановки или автобуса с данным названием, остальные пропускаются
+        void BulkLoad(const BaseRequestBatch& batch);
+        // Наполняет пустой справочник по id без поиска по названиям: пул названий подключается к арене
+        // без копирования, остановка i получает StopId i, расстояния и маршруты переносятся по id.
+        // Ссылки и id не перепроверяются (их проверяет источник образа). Уведомления не рассылаются.
+        // std::logic_error, если справочник не пуст
+        void LoadImage(const CatalogueImage& image);
+
+        // Замораживает справочник после загрузки: строит индексы поиска по названию.
+        // Новая или изменённая остановка либо автобус сбрасывает их; дорожные расстояния в индексы не входят
+        // и заморозку не снимают. Запросы работают и без заморозки,
+        // но тогда нужные им упорядочивания и индексы строятся при каждом вызове
+        void Freeze();
+        bool IsFrozen() const;
 
         const Bus* FindBusByName(std::string_view bus_name) const;
         const Stop* FindStopByName(std::string_view stop_name) const;
+        const Stop* GetStopById(StopId id) const;
+        // Координаты остановок с предвычисленной тригонометрией, индексируются StopId
+        const geo::CoordinatesTable& GetStopCoordinates() const;
+        // Остановки не дальше radius метров от center (не более count), по возрастанию расстояния
+        std::vector<NearbyStop> FindNearbyStops(geo::Coordinates center, double radius, size_t count) const;
+        // Автобусы, на которых можно доехать от from до to без пересадок, по названию.
+        // std::nullopt, если одной из остановок нет
+        std::optional<std::vector<const Bus*>> GetDirectBuses(std::string_view from, std::string_view to) const;
+        // Пространственный индекс остановок (точки индексируются StopId). Доступен для замороженного справочника
+        const geo::GridIndex& GetStopGrid() const;
+
+        //--номер названия (rank) замороженного справочника — его позиция по возрастанию; nullptr без индексов
+        const Stop* GetStopByRank(size_t rank) const;
+        const Bus* GetBusByRank(size_t rank) const;
+        // Все остановки по возрастанию названия
+        std::vector<const Stop*> GetSortedStops() const;
+        // Остановки, через которые проходит хотя бы один автобус, по возрастанию названия
+        std::vector<const Stop*> GetSortedStopsInRoutes() const;
+        std::vector<const Bus*> GetSortedBuses() const;
+        // Названия автобусов, проходящих через остановку, по возрастанию. std::nullopt, если остановки нет
+        std::optional<std::vector<std::string_view>> GetBusesByStop(std::string_view stop_name) const;
+        // Не более count остановок, названия которых начинаются с prefix: по возрастанию названия
+        // либо (by_bus_count) по убыванию числа автобусов, а при равенстве по названию
+        std::vector<StopSuggestion> SuggestStops(std::string_view prefix, size_t count, bool by_bus_count) const;
 
         double GetStopsDistance(std::string_view from, std::string_view to) const;
-        std::optional<std::set<std::string_view>> GetBusesByStop(std::string_view stop_name) const;
-        std::optional<RouteInfo> GetRouteInfoByBusName(const std::string& name) const;
-        const std::unordered_map<std::string_view, const Bus*>& GetBusData() const;
-        //const std::unordered_map<std::string_view, std::set<std::string_view>>& GetStopPerBuses() const;
-        std::set<std::string_view> GetSortedStopsInRoutes() const;
+        std::optional<RouteInfo> GetRouteInfoByBusName(std::string_view name) const;
+        const std::pmr::unordered_map<std::string_view, const Bus*>& GetBusData() const;
         
         //transport_router
-        const std::deque<Bus>& GetBuses() const;
-        std::set<std::string_view> GetSortedStopsInTask() const;
+        const std::pmr::deque<Bus>& GetBuses() const;
+        //catalogue_snapshot
+        const std::pmr::deque<Stop>& GetStops() const;
+        const std::pmr::unordered_map<std::pair<const Stop*, const Stop*>, double, StopHasher>& GetStopsDistances() const;
+        // Названия всех остановок и автобусов
+        const StringArena& GetNames() const;
         std::vector<TimeAndSpanCount> GetRouteTimeAndSpan(std::string_view bus_name, double bus_velocity) const;
+
+        // Память по структурам справочника, включая индексы замороженного справочника
+        MemoryReport GetMemoryReport() const;
     private:
-        const Stop* GetStopPtr(const std::string& name, const geo::Coordinates& coord);
+        // Монотонная арена поверх считающего источника блоков
+        struct Arena {
+            explicit Arena(size_t initial_size) : buffer(initial_size, &upstream) {
+            }
+            CountingResource upstream;
+            std::pmr::monotonic_buffer_resource buffer;
+        };
+
+        const Stop* ResolveStop(std::string_view name) const;
+        const Stop* CreateStop(std::string_view name, const geo::Coordinates& coord);
+        // Заменяет координаты остановки; false, если они не изменились
+        bool ReplaceStop(const Stop* stop, const geo::Coordinates& coord);
+        // Записывает расстояние; false, если оно уже было таким
+        bool StoreStopsDistance(std::pair<const Stop*, const Stop*> stops, double distance);
         std::string_view GetCopyStopName(std::string_view name);
-        const Bus* GetBusPtr(const std::string& name, const std::vector<std::string_view>& route,
-            const std::vector<std::string_view>& end_points, bool is_roundtrip, size_t end_point_idx);
-        std::string_view GetCopyBusName(std::string_view name);
-
-        std::deque<Stop> stops_;
-        std::deque<Bus> buses_;
-        std::unordered_map<std::string_view, const Stop*> stop_data_;
-        std::unordered_map<std::string_view, const Bus*> bus_data_;
-        mutable std::unordered_map<std::string_view, std::set<std::string_view>> stop_buses_;
-        std::unordered_map<std::pair<const Stop*, const Stop*>, double, StopHasher> stops_distance_;
-        std::set<std::string_view> stops_in_routes_;
-        std::set<std::string_view> stops_in_task_;
+        const Bus* CreateBus(std::string_view name, const std::vector<std::string_view>& stops, bool is_roundtrip);
+        // Заменяет маршрут автобуса; false, если он не изменился
+        bool ReplaceBus(const Bus* bus, const std::vector<std::string_view>& stops, bool is_roundtrip);
+        void Unfreeze();
+        void BuildStopBusIndex();
+        void BuildNameDictionaries();
+        const uint64_t* GetStopBusBits(StopId id) const;
+
+        //--объявлена первой, чтобы разрушаться после всех контейнеров
+        std::unique_ptr<Arena> memory_;
+        StringArena names_;
+        std::pmr::deque<Stop> stops_;
+        geo::CoordinatesTable stop_coords_;
+        std::pmr::deque<Bus> buses_;
+        std::pmr::unordered_map<std::string_view, const Stop*> stop_data_;
+        std::pmr::unordered_map<std::string_view, const Bus*> bus_data_;
+        std::pmr::unordered_map<std::pair<const Stop*, const Stop*>, double, StopHasher> stops_distance_;
+        ChangeListener* listener_ = nullptr;
+        //--индексы замороженного справочника
+        bool frozen_ = false;
+        PerfectHashIndex<const Stop*> stop_index_;
+        PerfectHashIndex<const Bus*> bus_index_;
+        geo::GridIndex stop_grid_;
+        //--битовые множества автобусов для каждой остановки: stop_bus_words_ слов на остановку
+        size_t stop_bus_words_ = 0;
+        std::vector<uint64_t> stop_bus_bits_;
+        //--остановки автобусов в прямом направлении в виде StopId (формат CSR по BusId)
+        std::vector<size_t> route_offsets_;
+        std::vector<StopId> route_stop_ids_;
+        //--словари названий и перестановки rank -> id (select); для автобусов также id -> rank
+        FrontCodedDictionary stop_names_;
+        FrontCodedDictionary bus_names_;
+        std::vector<StopId> stop_by_rank_;
+        std::vector<BusId> bus_by_rank_;
+        std::vector<size_t> bus_rank_;
+        //--число автобусов через каждую остановку в порядке названий
+        RangeMaxIndex stop_bus_counts_;
     };
 
 }
@@ -1,14 +1,16 @@
 #include "transport_router.h"
 
+#include <type_traits>
+
 
 namespace routing {
 
 	TransportRouter::TransportRouter(const model::TransportCatalogue& catalogue, const RoutingSettings& settings)		
-		: catalogue_(catalogue), settings_(settings) {
+		: catalogue_(catalogue), settings_(settings), memory_(&memory_upstream_), stop_to_vertex_(&memory_), edge_to_item_(&memory_) {
 
-		BuildStopsVertices(catalogue.GetSortedStopsInTask());
+		BuildStopsVertices(catalogue.GetSortedStops());
 		BuildGraph(catalogue.GetBuses());
-		router_ = std::make_unique<Router>(*graph_);
+		router_ = std::make_unique<Router>(*graph_, &memory_);
 	}
 
 	std::optional<ResponseData> TransportRouter::BuildRoute(std::string_view from, std::string_view to) const {
@@ -30,45 +32,95 @@ namespace routing {
 		return response;
 	}
 
-	void TransportRouter::BuildStopsVertices(const std::set<std::string_view>& stops) {
+	model::MemoryReport TransportRouter::GetMemoryReport() const {
+		model::MemoryReport report;
+		report.arena_bytes = memory_upstream_.GetAllocatedBytes();
+		report.Add("stop_to_vertex", stop_to_vertex_.size(), model::HashTableBytes(stop_to_vertex_));
+		size_t item_bytes = model::HashTableBytes(edge_to_item_);
+		for (const auto& [edge, item] : edge_to_item_) {
+			item_bytes += std::visit([](const auto& value) {
+				using T = std::decay_t<decltype(value)>;
+				size_t bytes = model::StringHeapBytes(value.type);
+				if constexpr (std::is_same_v<T, WaitItem>) {
+					bytes += model::StringHeapBytes(value.stop_name);
+				}
+				else if constexpr (std::is_same_v<T, BusItem>) {
+					bytes += model::StringHeapBytes(value.bus_name);
+				}
+				else {
+					bytes += model::StringHeapBytes(value.from) + model::StringHeapBytes(value.to);
+				}
+				return bytes;
+				}, item);
+		}
+		report.Add("edge_to_item", edge_to_item_.size(), item_bytes);
+		report.Add("graph", graph_->GetEdgeCount(), graph_->GetMemoryUsage());
+		report.Add("route_table", graph_->GetVertexCount() * graph_->GetVertexCount(), router_->GetMemoryUsage());
+		return report;
+	}
+
+	void TransportRouter::BuildStopsVertices(const std::vector<const model::Stop*>& sorted_stops) {
 		graph::VertexId start = 0;
 		graph::VertexId end = 1;
-		stop_to_vertex_.reserve(stops.size());
-		for (std::string_view stop : stops) {
-			stop_to_vertex_.emplace(stop, StopVertices{ start, end });
+		stop_to_vertex_.reserve(sorted_stops.size());
+		for (const model::Stop* stop : sorted_stops) {
+			stop_to_vertex_.emplace(stop->name, StopVertices{ start, end });
 			start += 2;
 			end += 2;
 		}
 	}
 
-	void TransportRouter::AddBusEdges(const model::Bus& bus) {
+	void TransportRouter::AddBusEdges(const model::Bus& bus, EdgeList& edge_list) const {
 		const auto& dist_time_span = catalogue_.GetRouteTimeAndSpan(bus.name, settings_.bus_velocity);
 		for (const auto& [from, to, time, span_count] : dist_time_span) {
-			auto vertex_from = stop_to_vertex_[from].end;
-			auto vertex_to = stop_to_vertex_[to].start;
+			auto vertex_from = stop_to_vertex_.at(from).end;
+			auto vertex_to = stop_to_vertex_.at(to).start;
 
-			auto bus_edge = graph::Edge<Weight>{ vertex_from, vertex_to, time };
-			graph_->AddEdge(bus_edge);
-			edge_to_item_.emplace(bus_edge, BusItem(time, bus.name, span_count));
+			edge_list.Add(graph::Edge<Weight>{ vertex_from, vertex_to, time }, BusItem(time, bus.name, span_count));
 		}
 	}
 
-	void TransportRouter::BuildGraph(const std::deque<model::Bus>& buses) {
-		graph_ = std::make_unique<Graph>(stop_to_vertex_.size() * 2);
-
+	void TransportRouter::BuildGraph(const std::pmr::deque<model::Bus>& buses) {
+		EdgeList edge_list;
 		double bus_wait_time = static_cast<double>(settings_.bus_wait_time);
-		auto wait_edge = graph::Edge<Weight>{};
 
 		for (auto [stop_name, stop_vertices] : stop_to_vertex_) {
-			wait_edge = graph::Edge<Weight>{ stop_vertices.start, stop_vertices.end, bus_wait_time };
-
-			graph_->AddEdge(wait_edge);
-			edge_to_item_.emplace(wait_edge, WaitItem(bus_wait_time, stop_name));
+			edge_list.Add(graph::Edge<Weight>{ stop_vertices.start, stop_vertices.end, bus_wait_time }, WaitItem(bus_wait_time, stop_name));
 		}
 
 		for (const auto& bus : buses) {
-			AddBusEdges(bus);
+			AddBusEdges(bus, edge_list);
 		}
+
+		if (settings_.walk_radius > 0. && settings_.walk_velocity > 0.) {
+			AddWalkEdges(edge_list);
+		}
+
+		//--число рёбер известно заранее: граф и таблица описаний размечаются в арене один раз, без роста
+		graph_ = std::make_unique<Graph>(stop_to_vertex_.size() * 2, edge_list.edges, &memory_);
+		edge_to_item_.reserve(edge_list.edges.size());
+		for (size_t i = 0; i < edge_list.edges.size(); ++i) {
+			edge_to_item_.emplace(edge_list.edges[i], std::move(edge_list.items[i]));
+		}
+	}
+
+	void TransportRouter::AddWalkEdges(EdgeList& edge_list) const {
+		//--пары близких остановок ищутся по сетке, а не перебором всех пар
+		auto add_walk_edge = [this, &edge_list](const model::Stop* from, const model::Stop* to, double distance) {
+			double walk_time = distance / settings_.walk_velocity;
+			auto walk_edge = graph::Edge<Weight>{ stop_to_vertex_.at(from->name).start, stop_to_vertex_.at(to->name).start, walk_time };
+			edge_list.Add(walk_edge, WalkItem(walk_time, from->name, to->name));
+		};
+		//--справочник без заморозки не хранит сетку: она строится на время разметки
+		const geo::GridIndex local_grid = catalogue_.IsFrozen() ? geo::GridIndex() : geo::GridIndex(catalogue_.GetStopCoordinates());
+		const geo::GridIndex& grid = catalogue_.IsFrozen() ? catalogue_.GetStopGrid() : local_grid;
+		grid.ForEachPairWithin(settings_.walk_radius,
+			[&](model::StopId first, model::StopId second, double distance) {
+				const model::Stop* first_stop = catalogue_.GetStopById(first);
+				const model::Stop* second_stop = catalogue_.GetStopById(second);
+				add_walk_edge(first_stop, second_stop, distance);
+				add_walk_edge(second_stop, first_stop, distance);
+			});
 	}
 
 
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <variant>
 #include <memory>
+#include <memory_resource>
 
 using namespace std::literals;
 
@@ -14,6 +15,9 @@ namespace routing {
 	struct RoutingSettings {
 		int bus_wait_time = 0;		//	min
 		double bus_velocity = 0.;	//	m/min
+		//--пешие пересадки между остановками, отключены при walk_radius == 0
+		double walk_radius = 0.;	//	m
+		double walk_velocity = 0.;	//	m/min
 	};
 
 	struct WaitItem {
@@ -26,7 +30,7 @@ namespace routing {
 	};
 
 	struct BusItem {
-		BusItem(double time, const std::string& bus_name, int span_count)
+		BusItem(double time, std::string_view bus_name, int span_count)
 			: time(time), bus_name(bus_name), span_count(span_count){
 		}		
 		double time = 0.;
@@ -35,7 +39,17 @@ namespace routing {
 		int span_count = 0;
 	};
 
-	using Item = std::variant<WaitItem, BusItem>;
+	struct WalkItem {
+		WalkItem(double time, std::string_view from, std::string_view to)
+			: time(time), from(from), to(to) {
+		}
+		double time = 0.;
+		std::string from;
+		std::string to;
+		std::string type = "Walk"s;
+	};
+
+	using Item = std::variant<WaitItem, BusItem, WalkItem>;
 
 	struct ResponseData {
 		double total_time = 0.;
@@ -52,6 +66,9 @@ namespace routing {
 
 		std::optional<ResponseData> BuildRoute(std::string_view from, std::string_view to) const;
 
+		// Память по структурам маршрутизатора
+		model::MemoryReport GetMemoryReport() const;
+
 	private:
 		struct StopVertices {
 			graph::VertexId start = 0;
@@ -67,14 +84,29 @@ namespace routing {
 			std::hash<size_t> hasher_;
 		};
 		
-		void BuildStopsVertices(const std::set<std::string_view>& stops);
-		void AddBusEdges(const model::Bus& bus);
-		void BuildGraph(const std::deque<model::Bus>& buses);
+		// Рёбра в порядке их будущих номеров и описания к ним; собираются вне арены до построения графа
+		struct EdgeList {
+			void Add(const graph::Edge<Weight>& edge, Item item) {
+				edges.push_back(edge);
+				items.push_back(std::move(item));
+			}
+
+			std::vector<graph::Edge<Weight>> edges;
+			std::vector<Item> items;
+		};
+		
+		void BuildStopsVertices(const std::vector<const model::Stop*>& sorted_stops);
+		void AddBusEdges(const model::Bus& bus, EdgeList& edge_list) const;
+		void BuildGraph(const std::pmr::deque<model::Bus>& buses);
+		void AddWalkEdges(EdgeList& edge_list) const;
 
 		const model::TransportCatalogue& catalogue_;
 		RoutingSettings settings_;
-		std::unordered_map<std::string_view, StopVertices> stop_to_vertex_;
-		std::unordered_map<graph::Edge<Weight>, Item, EdgeHash> edge_to_item_;
+		//--арена графа, таблицы маршрутов и индексов; освобождается целиком вместе с роутером
+		model::CountingResource memory_upstream_;
+		std::pmr::monotonic_buffer_resource memory_;
+		std::pmr::unordered_map<std::string_view, StopVertices> stop_to_vertex_;
+		std::pmr::unordered_map<graph::Edge<Weight>, Item, EdgeHash> edge_to_item_;
 		std::unique_ptr<Graph> graph_ = nullptr;
 		std::unique_ptr<Router> router_ = nullptr;
 	};